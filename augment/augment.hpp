@@ -0,0 +1,66 @@
+#ifndef AUGMENT_HPP
+#define AUGMENT_HPP
+
+#include <cstddef>
+
+// Политики дополнения узлов дерева.
+// Политика задает NodeData (примешивается к узлу) и update(node),
+// пересчитывающий данные узла по его детям. Tree вызывает update после
+// каждого изменения структуры: вращений, вставки и удаления.
+// Данные sentinel-узла остаются значениями по умолчанию.
+
+// Без дополнения: пустой NodeData, никаких накладных расходов
+struct NoAugment {
+    static constexpr bool enabled = false;
+    static constexpr bool hasSubtreeSize = false;
+
+    struct NodeData {};
+
+    template <typename Node>
+    static void update(Node*) {}
+};
+
+// Размер поддерева в каждом узле: nth, rank и count_range за O(log n)
+struct OrderStatistics {
+    static constexpr bool enabled = true;
+    static constexpr bool hasSubtreeSize = true;
+
+    struct NodeData {
+        std::size_t subtreeSize = 0;
+    };
+
+    template <typename Node>
+    static void update(Node* node) {
+        node->subtreeSize = node->left->subtreeSize + node->right->subtreeSize + 1;
+    }
+};
+
+// Пользовательский моноид на поддереве (плюс размеры поддеревьев).
+// Monoid должен предоставлять:
+//   using value_type;
+//   static value_type identity();
+//   static value_type lift(const T& value);
+//   static value_type combine(const value_type& a, const value_type& b);  // ассоциативная
+// Коммутативность не требуется: combine всегда вызывается в порядке ключей.
+template <typename Monoid>
+struct MonoidAugment {
+    static constexpr bool enabled = true;
+    static constexpr bool hasSubtreeSize = true;
+
+    using aggregate_type = typename Monoid::value_type;
+    using monoid_type = Monoid;
+
+    struct NodeData : OrderStatistics::NodeData {
+        aggregate_type subtreeAggregate = Monoid::identity();
+    };
+
+    template <typename Node>
+    static void update(Node* node) {
+        OrderStatistics::update(node);
+        node->subtreeAggregate = Monoid::combine(
+            Monoid::combine(node->left->subtreeAggregate, Monoid::lift(node->val)),
+            node->right->subtreeAggregate);
+    }
+};
+
+#endif // AUGMENT_HPP
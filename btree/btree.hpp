@@ -0,0 +1,928 @@
+#ifndef BTREE_HPP
+#define BTREE_HPP
+
+#include <cstddef>
+#include <utility>
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <functional>
+#include "../tree/key_compare.hpp"
+#include "../node_pool/node_pool.hpp"
+#include "../frozen/frozen_tree.hpp"
+
+// Предварительное объявление для итератора
+template <typename BTreeT>
+class BTreeIterator;
+
+// B-дерево с широкими узлами: значения узла лежат подряд, поэтому на уровень
+// приходится один-два промаха кэша, а уровней в разы меньше, чем у красно-черного дерева.
+// Интерфейс повторяет Tree, индекс переключается сменой одного типа.
+// NodeBytes - размер листа в байтах (по умолчанию четыре кэш-линии).
+// В отличие от Tree, insert и erase инвалидируют итераторы: значения сдвигаются внутри узлов.
+template <typename T, typename Compare = std::less<T>, typename Allocator = std::allocator<T>,
+          std::size_t NodeBytes = 256>
+class BTree {
+public:
+    // Типы
+    using iterator = BTreeIterator<BTree>;
+    using value_type = T;
+    using key_type = T;
+    using size_type = size_t;
+    using key_compare = Compare;
+    using value_compare = Compare;
+    using allocator_type = Allocator;
+    using difference_type = std::ptrdiff_t;
+
+    // Конструкторы и деструктор
+    BTree();
+    explicit BTree(const Compare& comp, const Allocator& alloc = Allocator());
+    explicit BTree(const Allocator& alloc);
+    template <typename InputIt>
+    BTree(InputIt first, InputIt last, const Compare& comp = Compare(), const Allocator& alloc = Allocator());
+    BTree(const BTree& other);
+    BTree(BTree&& other) noexcept;
+    ~BTree();
+
+    // Операторы присваивания
+    BTree& operator=(const BTree& other);
+    BTree& operator=(BTree&& other) noexcept;
+
+    // Основные операции
+    std::pair<iterator, bool> insert(const T& value);
+    std::pair<iterator, bool> insert(T&& value);
+    template <typename... Args>
+    std::pair<iterator, bool> emplace(Args&&... args);
+    size_type erase(const T& value);
+    iterator find(const T& value);
+
+    // Гетерогенный поиск (только для прозрачных компараторов)
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    size_type erase(const K& key);
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    iterator find(const K& key);
+
+    // Поиск границ за O(log n)
+    iterator lower_bound(const T& value) const;
+    iterator upper_bound(const T& value) const;
+    std::pair<iterator, iterator> equal_range(const T& value) const;
+    size_type count(const T& value) const;
+    bool contains(const T& value) const;
+
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    iterator lower_bound(const K& key) const;
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    iterator upper_bound(const K& key) const;
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    std::pair<iterator, iterator> equal_range(const K& key) const;
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    size_type count(const K& key) const;
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    bool contains(const K& key) const;
+
+    iterator begin();
+    iterator end();
+    iterator begin() const;
+    iterator end() const;
+    iterator cbegin() const;
+    iterator cend() const;
+
+    // Информация о дереве
+    size_type size() const;
+    bool empty() const;
+    void clear();
+    allocator_type get_allocator() const;
+    key_compare key_comp() const;
+
+    // Неизменяемый снимок для частых запросов, O(n)
+    FrozenTree<T, Compare, Allocator> freeze() const;
+
+    // Число значений в узле
+    static constexpr size_type node_capacity();
+
+private:
+    // Заголовок узла: parent + position/count/leaf, выровненные до двух указателей
+    static constexpr size_type headerBytes = 2 * sizeof(void*);
+    static constexpr size_type capacity =
+        NodeBytes >= headerBytes + 3 * sizeof(T)
+            ? std::min<size_type>((NodeBytes - headerBytes) / sizeof(T), 0xFFFF - 1)
+            : 3;
+    // Минимальное заполнение узла (кроме корня); слияние двух соседей всегда помещается в узел
+    static constexpr size_type minCount = (capacity - 1) / 2;
+
+    // Лист: значения без детей. Значения конструируются на месте только в [0, count)
+    struct Node {
+        Node* parent;
+        unsigned short position;  // Индекс в children родителя
+        unsigned short count;
+        bool leaf;
+        alignas(T) unsigned char storage[capacity * sizeof(T)];
+
+        explicit Node(bool isLeaf) : parent(nullptr), position(0), count(0), leaf(isLeaf) {}
+
+        T* values() { return reinterpret_cast<T*>(storage); }
+        const T* values() const { return reinterpret_cast<const T*>(storage); }
+    };
+
+    // Внутренний узел: count значений разделяют count + 1 детей
+    struct InnerNode : Node {
+        Node* children[capacity + 1];
+
+        InnerNode() : Node(false) {}
+    };
+
+    using LeafPool = NodePool<Node, Allocator>;
+    using InnerPool = NodePool<InnerNode, Allocator>;
+
+    Node* root;  // nullptr у пустого дерева
+    size_type treeSize;
+    Compare comp;
+    allocator_type alloc;
+    std::unique_ptr<LeafPool> leafNodes;
+    std::unique_ptr<InnerPool> innerNodes;
+
+    static InnerNode* inner(Node* node);
+    static const InnerNode* inner(const Node* node);
+    static void setChild(InnerNode* node, size_type i, Node* child);
+
+    // Создание и уничтожение узлов
+    Node* createLeaf();
+    InnerNode* createInner();
+    void destroyNode(Node* node);
+
+    // Сдвиги значений внутри узла
+    template <typename V>
+    void insertAt(Node* node, size_type pos, V&& value);
+    void removeAt(Node* node, size_type pos);
+    void insertSeparator(InnerNode* parent, size_type pos, T&& value, Node* right);
+
+    // Балансировка
+    void splitNode(Node* node, size_type insertPos);
+    void rebalance(Node* node);
+    void mergeWithRight(Node* left);
+    void borrowFromLeft(Node* node);
+    void borrowFromRight(Node* node);
+
+    template <typename V>
+    std::pair<iterator, bool> insertValue(V&& value);
+    template <typename K>
+    size_type eraseKey(const K& key);
+
+    // Поиск
+    template <typename K>
+    size_type nodeSearch(const Node* node, const K& key, bool& exact) const;
+    template <typename K>
+    std::pair<Node*, size_type> search(const K& key) const;
+    template <typename K>
+    iterator lowerBound(const K& key) const;
+    template <typename K>
+    iterator upperBound(const K& key) const;
+    template <typename K>
+    std::pair<iterator, iterator> equalRange(const K& key) const;
+    Node* leftmost(Node* node) const;
+    Node* rightmost(Node* node) const;
+    void increment(Node*& node, size_type& pos) const;
+    void decrement(Node*& node, size_type& pos) const;
+
+    // Рекурсивные методы
+    void destroyValues(Node* node);
+    Node* copyRecursive(const Node* node);
+
+    // Дружественный класс для итератора
+    friend class BTreeIterator<BTree>;
+};
+
+// Включаем реализацию итератора после определения BTree
+#include "../iterator/btree_iterator.hpp"
+
+// Реализация методов BTree
+
+template <typename T, typename Compare, typename Allocator, std::size_t NodeBytes>
+BTree<T, Compare, Allocator, NodeBytes>::BTree() : BTree(Compare(), Allocator()) {}
+
+template <typename T, typename Compare, typename Allocator, std::size_t NodeBytes>
+BTree<T, Compare, Allocator, NodeBytes>::BTree(const Allocator& alloc) : BTree(Compare(), alloc) {}
+
+template <typename T, typename Compare, typename Allocator, std::size_t NodeBytes>
+BTree<T, Compare, Allocator, NodeBytes>::BTree(const Compare& comp, const Allocator& alloc)
+    : root(nullptr), treeSize(0), comp(comp), alloc(alloc) {}
+
+template <typename T, typename Compare, typename Allocator, std::size_t NodeBytes>
+template <typename InputIt>
+BTree<T, Compare, Allocator, NodeBytes>::BTree(InputIt first, InputIt last, const Compare& comp, const Allocator& alloc)
+    : BTree(comp, alloc) {
+    // Отсортированный вход заполняет листья целиком (см. splitNode)
+    for (; first != last; ++first) {
+        insert(*first);
+    }
+}
+
+template <typename T, typename Compare, typename Allocator, std::size_t NodeBytes>
+BTree<T, Compare, Allocator, NodeBytes>::BTree(const BTree& other)
+    : BTree(other.comp, std::allocator_traits<Allocator>::select_on_container_copy_construction(other.alloc)) {
+    if (other.root != nullptr) {
+        root = copyRecursive(other.root);
+        treeSize = other.treeSize;
+    }
+}
+
+template <typename T, typename Compare, typename Allocator, std::size_t NodeBytes>
+BTree<T, Compare, Allocator, NodeBytes>::BTree(BTree&& other) noexcept
+    : root(other.root), treeSize(other.treeSize), comp(std::move(other.comp)), alloc(other.alloc),
+      leafNodes(std::move(other.leafNodes)), innerNodes(std::move(other.innerNodes)) {
+    other.root = nullptr;
+    other.treeSize = 0;
+}
+
+template <typename T, typename Compare, typename Allocator, std::size_t NodeBytes>
+BTree<T, Compare, Allocator, NodeBytes>::~BTree() {
+    clear();
+}
+
+template <typename T, typename Compare, typename Allocator, std::size_t NodeBytes>
+BTree<T, Compare, Allocator, NodeBytes>& BTree<T, Compare, Allocator, NodeBytes>::operator=(const BTree& other) {
+    if (this != &other) {
+        clear();
+        comp = other.comp;
+        if (other.root != nullptr) {
+            root = copyRecursive(other.root);
+            treeSize = other.treeSize;
+        }
+    }
+    return *this;
+}
+
+template <typename T, typename Compare, typename Allocator, std::size_t NodeBytes>
+BTree<T, Compare, Allocator, NodeBytes>& BTree<T, Compare, Allocator, NodeBytes>::operator=(BTree&& other) noexcept {
+    if (this != &other) {
+        clear();
+        root = other.root;
+        treeSize = other.treeSize;
+        comp = std::move(other.comp);
+        alloc = other.alloc;
+        leafNodes = std::move(other.leafNodes);
+        innerNodes = std::move(other.innerNodes);
+        other.root = nullptr;
+        other.treeSize = 0;
+    }
+    return *this;
+}
+
+template <typename T, typename Compare, typename Allocator, std::size_t NodeBytes>
+constexpr typename BTree<T, Compare, Allocator, NodeBytes>::size_type BTree<T, Compare, Allocator, NodeBytes>::node_capacity() {
+    return capacity;
+}
+
+template <typename T, typename Compare, typename Allocator, std::size_t NodeBytes>
+typename BTree<T, Compare, Allocator, NodeBytes>::InnerNode* BTree<T, Compare, Allocator, NodeBytes>::inner(Node* node) {
+    return static_cast<InnerNode*>(node);
+}
+
+template <typename T, typename Compare, typename Allocator, std::size_t NodeBytes>
+const typename BTree<T, Compare, Allocator, NodeBytes>::InnerNode* BTree<T, Compare, Allocator, NodeBytes>::inner(const Node* node) {
+    return static_cast<const InnerNode*>(node);
+}
+
+template <typename T, typename Compare, typename Allocator, std::size_t NodeBytes>
+void BTree<T, Compare, Allocator, NodeBytes>::setChild(InnerNode* node, size_type i, Node* child) {
+    node->children[i] = child;
+    child->parent = node;
+    child->position = static_cast<unsigned short>(i);
+}
+
+template <typename T, typename Compare, typename Allocator, std::size_t NodeBytes>
+typename BTree<T, Compare, Allocator, NodeBytes>::Node* BTree<T, Compare, Allocator, NodeBytes>::createLeaf() {
+    if (!leafNodes) {
+        leafNodes = std::make_unique<LeafPool>(alloc);
+    }
+    return leafNodes->create(true);
+}
+
+template <typename T, typename Compare, typename Allocator, std::size_t NodeBytes>
+typename BTree<T, Compare, Allocator, NodeBytes>::InnerNode* BTree<T, Compare, Allocator, NodeBytes>::createInner() {
+    if (!innerNodes) {
+        innerNodes = std::make_unique<InnerPool>(alloc);
+    }
+    return innerNodes->create();
+}
+
+template <typename T, typename Compare, typename Allocator, std::size_t NodeBytes>
+void BTree<T, Compare, Allocator, NodeBytes>::destroyNode(Node* node) {
+    T* values = node->values();
+    for (size_type i = 0; i < node->count; ++i) {
+        values[i].~T();
+    }
+    if (node->leaf) {
+        leafNodes->destroy(node);
+    } else {
+        innerNodes->destroy(inner(node));
+    }
+}
+
+template <typename T, typename Compare, typename Allocator, std::size_t NodeBytes>
+template <typename V>
+void BTree<T, Compare, Allocator, NodeBytes>::insertAt(Node* node, size_type pos, V&& value) {
+    T* values = node->values();
+    size_type count = node->count;
+    if (pos == count) {
+        ::new (static_cast<void*>(values + count)) T(std::forward<V>(value));
+    } else {
+        ::new (static_cast<void*>(values + count)) T(std::move(values[count - 1]));
+        std::move_backward(values + pos, values + count - 1, values + count);
+        values[pos] = std::forward<V>(value);
+    }
+    node->count++;
+}
+
+template <typename T, typename Compare, typename Allocator, std::size_t NodeBytes>
+void BTree<T, Compare, Allocator, NodeBytes>::removeAt(Node* node, size_type pos) {
+    T* values = node->values();
+    std::move(values + pos + 1, values + node->count, values + pos);
+    values[node->count - 1].~T();
+    node->count--;
+}
+
+template <typename T, typename Compare, typename Allocator, std::size_t NodeBytes>
+void BTree<T, Compare, Allocator, NodeBytes>::insertSeparator(InnerNode* parent, size_type pos, T&& value, Node* right) {
+    // Значение встает на место pos, right - его правый ребенок
+    insertAt(parent, pos, std::move(value));
+    for (size_type i = parent->count; i > pos + 1; --i) {
+        setChild(parent, i, parent->children[i - 1]);
+    }
+    setChild(parent, pos + 1, right);
+}
+
+template <typename T, typename Compare, typename Allocator, std::size_t NodeBytes>
+void BTree<T, Compare, Allocator, NodeBytes>::splitNode(Node* node, size_type insertPos) {
+    // Медиана уходит в родителя, правая часть - в новый узел справа.
+    // Родитель при необходимости делится первым, поэтому место под медиану есть всегда.
+    if (node->parent == nullptr) {
+        InnerNode* top = createInner();
+        setChild(top, 0, node);
+        root = top;
+    } else if (node->parent->count == capacity) {
+        splitNode(node->parent, node->position);
+    }
+    InnerNode* parent = inner(node->parent);
+    Node* sibling = node->leaf ? createLeaf() : static_cast<Node*>(createInner());
+
+    // Вставка в край узла смещает точку деления: последовательная вставка
+    // оставляет за собой заполненные узлы, а не наполовину пустые
+    size_type mid = capacity / 2;
+    if (insertPos == capacity) {
+        mid = capacity - 1;
+    } else if (insertPos == 0) {
+        mid = 0;
+    }
+
+    T* values = node->values();
+    T* siblingValues = sibling->values();
+    size_type count = node->count;
+    for (size_type i = mid + 1; i < count; ++i) {
+        ::new (static_cast<void*>(siblingValues + (i - mid - 1))) T(std::move(values[i]));
+        values[i].~T();
+    }
+    sibling->count = static_cast<unsigned short>(count - mid - 1);
+    if (!node->leaf) {
+        for (size_type i = mid + 1; i <= count; ++i) {
+            setChild(inner(sibling), i - mid - 1, inner(node)->children[i]);
+        }
+    }
+
+    node->count = static_cast<unsigned short>(mid);
+    insertSeparator(parent, node->position, std::move(values[mid]), sibling);
+    values[mid].~T();
+}
+
+template <typename T, typename Compare, typename Allocator, std::size_t NodeBytes>
+void BTree<T, Compare, Allocator, NodeBytes>::rebalance(Node* node) {
+    // Недозаполненный узел занимает значение у соседа или сливается с ним;
+    // слияние забирает разделитель у родителя, и проверка поднимается выше
+    while (node != root) {
+        if (node->count >= minCount) {
+            return;
+        }
+        InnerNode* parent = inner(node->parent);
+        size_type pos = node->position;
+        if (pos > 0 && parent->children[pos - 1]->count > minCount) {
+            borrowFromLeft(node);
+            return;
+        }
+        if (pos < parent->count && parent->children[pos + 1]->count > minCount) {
+            borrowFromRight(node);
+            return;
+        }
+        mergeWithRight(pos > 0 ? parent->children[pos - 1] : node);
+        node = parent;
+    }
+
+    if (root->count == 0) {
+        Node* old = root;
+        if (root->leaf) {
+            root = nullptr;
+        } else {
+            root = inner(root)->children[0];
+            root->parent = nullptr;
+            root->position = 0;
+        }
+        destroyNode(old);
+    }
+}
+
+template <typename T, typename Compare, typename Allocator, std::size_t NodeBytes>
+void BTree<T, Compare, Allocator, NodeBytes>::mergeWithRight(Node* left) {
+    InnerNode* parent = inner(left->parent);
+    size_type pos = left->position;
+    Node* right = parent->children[pos + 1];
+    T* leftValues = left->values();
+    T* rightValues = right->values();
+    size_type leftCount = left->count;
+
+    ::new (static_cast<void*>(leftValues + leftCount)) T(std::move(parent->values()[pos]));
+    for (size_type i = 0; i < right->count; ++i) {
+        ::new (static_cast<void*>(leftValues + leftCount + 1 + i)) T(std::move(rightValues[i]));
+    }
+    if (!left->leaf) {
+        for (size_type i = 0; i <= right->count; ++i) {
+            setChild(inner(left), leftCount + 1 + i, inner(right)->children[i]);
+        }
+    }
+    left->count = static_cast<unsigned short>(leftCount + 1 + right->count);
+
+    removeAt(parent, pos);
+    for (size_type i = pos + 1; i <= parent->count; ++i) {
+        setChild(parent, i, parent->children[i + 1]);
+    }
+    destroyNode(right);
+}
+
+template <typename T, typename Compare, typename Allocator, std::size_t NodeBytes>
+void BTree<T, Compare, Allocator, NodeBytes>::borrowFromLeft(Node* node) {
+    // Разделитель опускается в node, последнее значение левого соседа встает на его место
+    InnerNode* parent = inner(node->parent);
+    size_type pos = node->position;
+    Node* left = parent->children[pos - 1];
+
+    insertAt(node, 0, std::move(parent->values()[pos - 1]));
+    parent->values()[pos - 1] = std::move(left->values()[left->count - 1]);
+    if (!node->leaf) {
+        for (size_type i = node->count; i > 0; --i) {
+            setChild(inner(node), i, inner(node)->children[i - 1]);
+        }
+        setChild(inner(node), 0, inner(left)->children[left->count]);
+    }
+    removeAt(left, left->count - 1);
+}
+
+template <typename T, typename Compare, typename Allocator, std::size_t NodeBytes>
+void BTree<T, Compare, Allocator, NodeBytes>::borrowFromRight(Node* node) {
+    InnerNode* parent = inner(node->parent);
+    size_type pos = node->position;
+    Node* right = parent->children[pos + 1];
+
+    insertAt(node, node->count, std::move(parent->values()[pos]));
+    parent->values()[pos] = std::move(right->values()[0]);
+    if (!node->leaf) {
+        setChild(inner(node), node->count, inner(right)->children[0]);
+        for (size_type i = 0; i < right->count; ++i) {
+            setChild(inner(right), i, inner(right)->children[i + 1]);
+        }
+    }
+    removeAt(right, 0);
+}
+
+template <typename T, typename Compare, typename Allocator, std::size_t NodeBytes>
+template <typename V>
+std::pair<typename BTree<T, Compare, Allocator, NodeBytes>::iterator, bool> BTree<T, Compare, Allocator, NodeBytes>::insertValue(V&& value) {
+    if (root == nullptr) {
+        root = createLeaf();
+        insertAt(root, 0, std::forward<V>(value));
+        treeSize = 1;
+        return std::make_pair(iterator(root, 0, this), true);
+    }
+
+    Node* node = root;
+    size_type pos;
+    while (true) {
+        bool exact;
+        pos = nodeSearch(node, static_cast<const T&>(value), exact);
+        if (exact) {
+            return std::make_pair(iterator(node, pos, this), false);
+        }
+        if (node->leaf) {
+            break;
+        }
+        node = inner(node)->children[pos];
+    }
+
+    if (node->count == capacity) {
+        splitNode(node, pos);
+        size_type mid = node->count;
+        if (pos > mid) {
+            node = inner(node->parent)->children[node->position + 1];
+            pos -= mid + 1;
+        }
+    }
+    insertAt(node, pos, std::forward<V>(value));
+    treeSize++;
+    return std::make_pair(iterator(node, pos, this), true);
+}
+
+template <typename T, typename Compare, typename Allocator, std::size_t NodeBytes>
+std::pair<typename BTree<T, Compare, Allocator, NodeBytes>::iterator, bool> BTree<T, Compare, Allocator, NodeBytes>::insert(const T& value) {
+    return insertValue(value);
+}
+
+template <typename T, typename Compare, typename Allocator, std::size_t NodeBytes>
+std::pair<typename BTree<T, Compare, Allocator, NodeBytes>::iterator, bool> BTree<T, Compare, Allocator, NodeBytes>::insert(T&& value) {
+    return insertValue(std::move(value));
+}
+
+template <typename T, typename Compare, typename Allocator, std::size_t NodeBytes>
+template <typename... Args>
+std::pair<typename BTree<T, Compare, Allocator, NodeBytes>::iterator, bool> BTree<T, Compare, Allocator, NodeBytes>::emplace(Args&&... args) {
+    // Значения хранятся в узле массивом, поэтому ключ сначала строится отдельно
+    T value(std::forward<Args>(args)...);
+    return insertValue(std::move(value));
+}
+
+template <typename T, typename Compare, typename Allocator, std::size_t NodeBytes>
+template <typename K>
+typename BTree<T, Compare, Allocator, NodeBytes>::size_type BTree<T, Compare, Allocator, NodeBytes>::eraseKey(const K& key) {
+    auto [node, pos] = search(key);
+    if (node == nullptr) {
+        return 0;
+    }
+
+    // Из внутреннего узла значение заменяется предшественником из листа
+    if (!node->leaf) {
+        Node* leaf = rightmost(inner(node)->children[pos]);
+        node->values()[pos] = std::move(leaf->values()[leaf->count - 1]);
+        node = leaf;
+        pos = leaf->count - 1;
+    }
+    removeAt(node, pos);
+    treeSize--;
+    rebalance(node);
+    return 1;
+}
+
+template <typename T, typename Compare, typename Allocator, std::size_t NodeBytes>
+typename BTree<T, Compare, Allocator, NodeBytes>::size_type BTree<T, Compare, Allocator, NodeBytes>::erase(const T& value) {
+    return eraseKey(value);
+}
+
+template <typename T, typename Compare, typename Allocator, std::size_t NodeBytes>
+template <typename K, typename C, typename>
+typename BTree<T, Compare, Allocator, NodeBytes>::size_type BTree<T, Compare, Allocator, NodeBytes>::erase(const K& key) {
+    return eraseKey(key);
+}
+
+template <typename T, typename Compare, typename Allocator, std::size_t NodeBytes>
+template <typename K>
+typename BTree<T, Compare, Allocator, NodeBytes>::size_type BTree<T, Compare, Allocator, NodeBytes>::nodeSearch(const Node* node, const K& key, bool& exact) const {
+    // Двоичный поиск внутри узла: индекс первого значения, не меньшего key
+    const T* values = node->values();
+    size_type lo = 0;
+    size_type hi = node->count;
+    if constexpr (tree_detail::hasThreeWay<Compare, T, K, T>()) {
+        while (lo < hi) {
+            size_type mid = (lo + hi) / 2;
+            int c = tree_detail::threeWay<Compare, T>(comp, key, values[mid]);
+            if (c == 0) {
+                exact = true;
+                return mid;
+            }
+            if (c < 0) {
+                hi = mid;
+            } else {
+                lo = mid + 1;
+            }
+        }
+        exact = false;
+    } else {
+        while (lo < hi) {
+            size_type mid = (lo + hi) / 2;
+            if (comp(values[mid], key)) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        exact = lo < node->count && !comp(key, values[lo]);
+    }
+    return lo;
+}
+
+template <typename T, typename Compare, typename Allocator, std::size_t NodeBytes>
+template <typename K>
+std::pair<typename BTree<T, Compare, Allocator, NodeBytes>::Node*, typename BTree<T, Compare, Allocator, NodeBytes>::size_type>
+BTree<T, Compare, Allocator, NodeBytes>::search(const K& key) const {
+    Node* node = root;
+    while (node != nullptr) {
+        bool exact;
+        size_type pos = nodeSearch(node, key, exact);
+        if (exact) {
+            return std::make_pair(node, pos);
+        }
+        node = node->leaf ? nullptr : inner(node)->children[pos];
+    }
+    return std::make_pair(nullptr, size_type(0));
+}
+
+template <typename T, typename Compare, typename Allocator, std::size_t NodeBytes>
+typename BTree<T, Compare, Allocator, NodeBytes>::iterator BTree<T, Compare, Allocator, NodeBytes>::find(const T& value) {
+    auto found = search(value);
+    return iterator(found.first, found.second, this);
+}
+
+template <typename T, typename Compare, typename Allocator, std::size_t NodeBytes>
+template <typename K, typename C, typename>
+typename BTree<T, Compare, Allocator, NodeBytes>::iterator BTree<T, Compare, Allocator, NodeBytes>::find(const K& key) {
+    auto found = search(key);
+    return iterator(found.first, found.second, this);
+}
+
+template <typename T, typename Compare, typename Allocator, std::size_t NodeBytes>
+template <typename K>
+typename BTree<T, Compare, Allocator, NodeBytes>::iterator BTree<T, Compare, Allocator, NodeBytes>::lowerBound(const K& key) const {
+    // Первое значение, не меньшее key; ответ - последний узел спуска, где такое нашлось
+    Node* node = root;
+    Node* resultNode = nullptr;
+    size_type resultPos = 0;
+    while (node != nullptr) {
+        bool exact;
+        size_type pos = nodeSearch(node, key, exact);
+        if (pos < node->count) {
+            resultNode = node;
+            resultPos = pos;
+            if (exact) {
+                break;
+            }
+        }
+        node = node->leaf ? nullptr : inner(node)->children[pos];
+    }
+    return iterator(resultNode, resultPos, this);
+}
+
+template <typename T, typename Compare, typename Allocator, std::size_t NodeBytes>
+template <typename K>
+typename BTree<T, Compare, Allocator, NodeBytes>::iterator BTree<T, Compare, Allocator, NodeBytes>::upperBound(const K& key) const {
+    // Первое значение, строго большее key
+    Node* node = root;
+    Node* resultNode = nullptr;
+    size_type resultPos = 0;
+    while (node != nullptr) {
+        const T* values = node->values();
+        size_type lo = 0;
+        size_type hi = node->count;
+        while (lo < hi) {
+            size_type mid = (lo + hi) / 2;
+            if (comp(key, values[mid])) {
+                hi = mid;
+            } else {
+                lo = mid + 1;
+            }
+        }
+        if (lo < node->count) {
+            resultNode = node;
+            resultPos = lo;
+        }
+        node = node->leaf ? nullptr : inner(node)->children[lo];
+    }
+    return iterator(resultNode, resultPos, this);
+}
+
+template <typename T, typename Compare, typename Allocator, std::size_t NodeBytes>
+template <typename K>
+std::pair<typename BTree<T, Compare, Allocator, NodeBytes>::iterator, typename BTree<T, Compare, Allocator, NodeBytes>::iterator>
+BTree<T, Compare, Allocator, NodeBytes>::equalRange(const K& key) const {
+    // Ключи уникальны: диапазон пуст или состоит из одного значения
+    iterator lower = lowerBound(key);
+    iterator upper = lower;
+    if (lower != end() && !comp(key, *lower)) {
+        ++upper;
+    }
+    return std::make_pair(lower, upper);
+}
+
+template <typename T, typename Compare, typename Allocator, std::size_t NodeBytes>
+typename BTree<T, Compare, Allocator, NodeBytes>::iterator BTree<T, Compare, Allocator, NodeBytes>::lower_bound(const T& value) const {
+    return lowerBound(value);
+}
+
+template <typename T, typename Compare, typename Allocator, std::size_t NodeBytes>
+typename BTree<T, Compare, Allocator, NodeBytes>::iterator BTree<T, Compare, Allocator, NodeBytes>::upper_bound(const T& value) const {
+    return upperBound(value);
+}
+
+template <typename T, typename Compare, typename Allocator, std::size_t NodeBytes>
+std::pair<typename BTree<T, Compare, Allocator, NodeBytes>::iterator, typename BTree<T, Compare, Allocator, NodeBytes>::iterator>
+BTree<T, Compare, Allocator, NodeBytes>::equal_range(const T& value) const {
+    return equalRange(value);
+}
+
+template <typename T, typename Compare, typename Allocator, std::size_t NodeBytes>
+typename BTree<T, Compare, Allocator, NodeBytes>::size_type BTree<T, Compare, Allocator, NodeBytes>::count(const T& value) const {
+    return search(value).first != nullptr ? 1 : 0;
+}
+
+template <typename T, typename Compare, typename Allocator, std::size_t NodeBytes>
+bool BTree<T, Compare, Allocator, NodeBytes>::contains(const T& value) const {
+    return search(value).first != nullptr;
+}
+
+template <typename T, typename Compare, typename Allocator, std::size_t NodeBytes>
+template <typename K, typename C, typename>
+typename BTree<T, Compare, Allocator, NodeBytes>::iterator BTree<T, Compare, Allocator, NodeBytes>::lower_bound(const K& key) const {
+    return lowerBound(key);
+}
+
+template <typename T, typename Compare, typename Allocator, std::size_t NodeBytes>
+template <typename K, typename C, typename>
+typename BTree<T, Compare, Allocator, NodeBytes>::iterator BTree<T, Compare, Allocator, NodeBytes>::upper_bound(const K& key) const {
+    return upperBound(key);
+}
+
+template <typename T, typename Compare, typename Allocator, std::size_t NodeBytes>
+template <typename K, typename C, typename>
+std::pair<typename BTree<T, Compare, Allocator, NodeBytes>::iterator, typename BTree<T, Compare, Allocator, NodeBytes>::iterator>
+BTree<T, Compare, Allocator, NodeBytes>::equal_range(const K& key) const {
+    return equalRange(key);
+}
+
+template <typename T, typename Compare, typename Allocator, std::size_t NodeBytes>
+template <typename K, typename C, typename>
+typename BTree<T, Compare, Allocator, NodeBytes>::size_type BTree<T, Compare, Allocator, NodeBytes>::count(const K& key) const {
+    return search(key).first != nullptr ? 1 : 0;
+}
+
+template <typename T, typename Compare, typename Allocator, std::size_t NodeBytes>
+template <typename K, typename C, typename>
+bool BTree<T, Compare, Allocator, NodeBytes>::contains(const K& key) const {
+    return search(key).first != nullptr;
+}
+
+template <typename T, typename Compare, typename Allocator, std::size_t NodeBytes>
+typename BTree<T, Compare, Allocator, NodeBytes>::Node* BTree<T, Compare, Allocator, NodeBytes>::leftmost(Node* node) const {
+    while (!node->leaf) {
+        node = inner(node)->children[0];
+    }
+    return node;
+}
+
+template <typename T, typename Compare, typename Allocator, std::size_t NodeBytes>
+typename BTree<T, Compare, Allocator, NodeBytes>::Node* BTree<T, Compare, Allocator, NodeBytes>::rightmost(Node* node) const {
+    while (!node->leaf) {
+        node = inner(node)->children[node->count];
+    }
+    return node;
+}
+
+template <typename T, typename Compare, typename Allocator, std::size_t NodeBytes>
+void BTree<T, Compare, Allocator, NodeBytes>::increment(Node*& node, size_type& pos) const {
+    // Из внутреннего узла - в начало правого поддерева, иначе вверх до первого непройденного значения
+    if (!node->leaf) {
+        node = leftmost(inner(node)->children[pos + 1]);
+        pos = 0;
+        return;
+    }
+    pos++;
+    while (pos >= node->count) {
+        if (node->parent == nullptr) {
+            node = nullptr;
+            pos = 0;
+            return;
+        }
+        pos = node->position;
+        node = node->parent;
+    }
+}
+
+template <typename T, typename Compare, typename Allocator, std::size_t NodeBytes>
+void BTree<T, Compare, Allocator, NodeBytes>::decrement(Node*& node, size_type& pos) const {
+    if (!node->leaf) {
+        node = rightmost(inner(node)->children[pos]);
+        pos = node->count - 1;
+        return;
+    }
+    while (pos == 0) {
+        if (node->parent == nullptr) {
+            node = nullptr;
+            return;
+        }
+        pos = node->position;
+        node = node->parent;
+    }
+    pos--;
+}
+
+template <typename T, typename Compare, typename Allocator, std::size_t NodeBytes>
+typename BTree<T, Compare, Allocator, NodeBytes>::iterator BTree<T, Compare, Allocator, NodeBytes>::begin() {
+    if (root == nullptr) {
+        return end();
+    }
+    return iterator(leftmost(root), 0, this);
+}
+
+template <typename T, typename Compare, typename Allocator, std::size_t NodeBytes>
+typename BTree<T, Compare, Allocator, NodeBytes>::iterator BTree<T, Compare, Allocator, NodeBytes>::end() {
+    return iterator(nullptr, 0, this);
+}
+
+template <typename T, typename Compare, typename Allocator, std::size_t NodeBytes>
+typename BTree<T, Compare, Allocator, NodeBytes>::iterator BTree<T, Compare, Allocator, NodeBytes>::begin() const {
+    if (root == nullptr) {
+        return end();
+    }
+    return iterator(leftmost(root), 0, this);
+}
+
+template <typename T, typename Compare, typename Allocator, std::size_t NodeBytes>
+typename BTree<T, Compare, Allocator, NodeBytes>::iterator BTree<T, Compare, Allocator, NodeBytes>::end() const {
+    return iterator(nullptr, 0, this);
+}
+
+template <typename T, typename Compare, typename Allocator, std::size_t NodeBytes>
+typename BTree<T, Compare, Allocator, NodeBytes>::iterator BTree<T, Compare, Allocator, NodeBytes>::cbegin() const {
+    return begin();
+}
+
+template <typename T, typename Compare, typename Allocator, std::size_t NodeBytes>
+typename BTree<T, Compare, Allocator, NodeBytes>::iterator BTree<T, Compare, Allocator, NodeBytes>::cend() const {
+    return end();
+}
+
+template <typename T, typename Compare, typename Allocator, std::size_t NodeBytes>
+typename BTree<T, Compare, Allocator, NodeBytes>::size_type BTree<T, Compare, Allocator, NodeBytes>::size() const {
+    return treeSize;
+}
+
+template <typename T, typename Compare, typename Allocator, std::size_t NodeBytes>
+bool BTree<T, Compare, Allocator, NodeBytes>::empty() const {
+    return root == nullptr;
+}
+
+template <typename T, typename Compare, typename Allocator, std::size_t NodeBytes>
+typename BTree<T, Compare, Allocator, NodeBytes>::allocator_type BTree<T, Compare, Allocator, NodeBytes>::get_allocator() const {
+    return alloc;
+}
+
+template <typename T, typename Compare, typename Allocator, std::size_t NodeBytes>
+typename BTree<T, Compare, Allocator, NodeBytes>::key_compare BTree<T, Compare, Allocator, NodeBytes>::key_comp() const {
+    return comp;
+}
+
+template <typename T, typename Compare, typename Allocator, std::size_t NodeBytes>
+FrozenTree<T, Compare, Allocator> BTree<T, Compare, Allocator, NodeBytes>::freeze() const {
+    return FrozenTree<T, Compare, Allocator>(begin(), size(), comp, get_allocator());
+}
+
+template <typename T, typename Compare, typename Allocator, std::size_t NodeBytes>
+void BTree<T, Compare, Allocator, NodeBytes>::destroyValues(Node* node) {
+    T* values = node->values();
+    for (size_type i = 0; i < node->count; ++i) {
+        values[i].~T();
+    }
+    if (!node->leaf) {
+        for (size_type i = 0; i <= node->count; ++i) {
+            destroyValues(inner(node)->children[i]);
+        }
+    }
+}
+
+template <typename T, typename Compare, typename Allocator, std::size_t NodeBytes>
+typename BTree<T, Compare, Allocator, NodeBytes>::Node* BTree<T, Compare, Allocator, NodeBytes>::copyRecursive(const Node* node) {
+    Node* copy = node->leaf ? createLeaf() : static_cast<Node*>(createInner());
+    const T* values = node->values();
+    for (size_type i = 0; i < node->count; ++i) {
+        ::new (static_cast<void*>(copy->values() + i)) T(values[i]);
+        copy->count++;
+    }
+    if (!node->leaf) {
+        for (size_type i = 0; i <= node->count; ++i) {
+            setChild(inner(copy), i, copyRecursive(inner(node)->children[i]));
+        }
+    }
+    return copy;
+}
+
+template <typename T, typename Compare, typename Allocator, std::size_t NodeBytes>
+void BTree<T, Compare, Allocator, NodeBytes>::clear() {
+    // Узлы возвращаются слэбами целиком, обход нужен только ради деструкторов значений
+    if (root != nullptr && !std::is_trivially_destructible<T>::value) {
+        destroyValues(root);
+    }
+    if (leafNodes) {
+        leafNodes->release();
+    }
+    if (innerNodes) {
+        innerNodes->release();
+    }
+    root = nullptr;
+    treeSize = 0;
+}
+
+#endif // BTREE_HPP
@@ -0,0 +1,637 @@
+#ifndef COMPACT_TREE_HPP
+#define COMPACT_TREE_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// Предварительное объявление для итератора
+template <typename CompactT>
+class CompactIterator;
+
+// Красно-черное дерево (левонаклонное, как persistent/cow_llrb.hpp) с компактными узлами
+// для мелких ключей: узлы лежат в одном массиве и ссылаются друг на друга 32-битными
+// номерами, цвет хранится в старшем бите номера правого ребенка, ссылки на родителя нет -
+// итераторы держат путь от корня. Узел Tree<int> занимает 12 байт вместо 40.
+// Массив всегда плотный: при удалении последний узел переезжает на место удаленного,
+// поэтому вставка и удаление делают итераторы недействительными.
+// optimize_layout() раскладывает узлы в порядке обхода в ширину: верхние уровни
+// дерева лежат рядом и делят кэш-линии.
+template <typename T, typename Compare = std::less<T>, typename Allocator = std::allocator<T>>
+class CompactTree {
+public:
+    // Типы
+    using iterator = CompactIterator<CompactTree>;
+    using const_iterator = iterator;
+    using value_type = T;
+    using key_type = T;
+    using size_type = size_t;
+    using key_compare = Compare;
+    using value_compare = Compare;
+    using allocator_type = Allocator;
+    using difference_type = std::ptrdiff_t;
+
+    // Конструкторы
+    CompactTree();
+    explicit CompactTree(const Compare& comp, const Allocator& alloc = Allocator());
+    // Построение за O(n) после сортировки, узлы сразу в порядке обхода в ширину
+    template <typename InputIt>
+    CompactTree(InputIt first, InputIt last, const Compare& comp = Compare(), const Allocator& alloc = Allocator());
+
+    // Основные операции, O(log n)
+    std::pair<iterator, bool> insert(const T& value);
+    std::pair<iterator, bool> insert(T&& value);
+    template <typename... Args>
+    std::pair<iterator, bool> emplace(Args&&... args);
+    size_type erase(const T& value);
+
+    iterator find(const T& value) const;
+    iterator lower_bound(const T& value) const;
+    iterator upper_bound(const T& value) const;
+    std::pair<iterator, iterator> equal_range(const T& value) const;
+    size_type count(const T& value) const;
+    bool contains(const T& value) const;
+
+    iterator begin() const;
+    iterator end() const;
+    iterator cbegin() const;
+    iterator cend() const;
+
+    // Информация о дереве
+    size_type size() const;
+    bool empty() const;
+    void clear();
+    void reserve(size_type count);
+    // Байты под узлы, включая запас массива
+    size_type memory_usage() const;
+    allocator_type get_allocator() const;
+    key_compare key_comp() const;
+
+    // Перекладка узлов в порядке обхода в ширину, O(n)
+    void optimize_layout();
+
+private:
+    using Index = std::uint32_t;
+    static constexpr Index NO_NODE = 0x7fffffff;
+    static constexpr Index RED_BIT = 0x80000000;
+
+    // Узел: номера детей (NO_NODE - нет ребенка), цвет - старший бит rightAndColor
+    struct Node {
+        T val;
+        Index left;
+        Index rightAndColor;
+
+        template <typename... Args>
+        explicit Node(std::in_place_t, Args&&... args)
+            : val(std::forward<Args>(args)...), left(NO_NODE), rightAndColor(NO_NODE | RED_BIT) {}
+
+        Index right() const {
+            return rightAndColor & ~RED_BIT;
+        }
+
+        void setRight(Index node) {
+            rightAndColor = (rightAndColor & RED_BIT) | node;
+        }
+
+        bool red() const {
+            return (rightAndColor & RED_BIT) != 0;
+        }
+
+        void setRed(bool isRed) {
+            rightAndColor = isRed ? rightAndColor | RED_BIT : rightAndColor & ~RED_BIT;
+        }
+    };
+
+    using NodeAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Node>;
+
+    std::vector<Node, NodeAllocator> nodes;
+    Index root;
+    Compare comp;
+
+    template <typename... Args>
+    Index makeNode(Args&&... args);
+    bool isRed(Index node) const;
+
+    // Спуск с запоминанием пути; путь обрезается до найденного узла
+    std::vector<Index> lowerBoundPath(const T& key) const;
+    std::vector<Index> upperBoundPath(const T& key) const;
+    template <typename V>
+    std::pair<iterator, bool> insertValue(V&& value);
+
+    // Алгоритмы LLRB над номерами узлов; возвращают новый корень поддерева
+    Index rotateLeft(Index h);
+    Index rotateRight(Index h);
+    void flipColors(Index h);
+    Index balance(Index h);
+    Index moveRedLeft(Index h);
+    Index moveRedRight(Index h);
+    template <typename V>
+    Index insertAt(Index h, V&& value, Index& target, bool& inserted);
+    Index eraseMin(Index h, Index& removed);
+    Index eraseAt(Index h, const T& key, Index& removed);
+    // Перенос последнего узла массива на освободившееся место
+    void relocateLast(Index hole);
+
+    // Построение из отсортированных уникальных значений как 2-3 дерева черной высоты height
+    template <typename It>
+    Index buildBalanced(It& it, size_type count, size_type height, const std::vector<size_type>& capacity);
+
+    friend class CompactIterator<CompactTree>;
+};
+
+// Включаем реализацию итератора после определения CompactTree
+#include "../iterator/compact_iterator.hpp"
+
+// Реализация методов CompactTree
+
+template <typename T, typename Compare, typename Allocator>
+CompactTree<T, Compare, Allocator>::CompactTree() : CompactTree(Compare(), Allocator()) {}
+
+template <typename T, typename Compare, typename Allocator>
+CompactTree<T, Compare, Allocator>::CompactTree(const Compare& comp, const Allocator& alloc)
+    : nodes(NodeAllocator(alloc)), root(NO_NODE), comp(comp) {}
+
+template <typename T, typename Compare, typename Allocator>
+template <typename InputIt>
+CompactTree<T, Compare, Allocator>::CompactTree(InputIt first, InputIt last, const Compare& comp, const Allocator& alloc)
+    : CompactTree(comp, alloc) {
+    std::vector<T> sorted(first, last);
+    std::sort(sorted.begin(), sorted.end(), comp);
+    sorted.erase(std::unique(sorted.begin(), sorted.end(), [&comp](const T& a, const T& b) {
+        return !comp(a, b) && !comp(b, a);
+    }), sorted.end());
+    if (sorted.size() >= NO_NODE) {
+        throw std::length_error("CompactTree is limited to 2^31 - 1 elements");
+    }
+    if (sorted.empty()) {
+        return;
+    }
+
+    // Наибольшая черная высота, при которой хватает ключей на полное дерево из 2-узлов;
+    // capacity[h] = 3^h - 1 - сколько ключей вмещает дерево высоты h из 3-узлов
+    size_type height = 0;
+    while ((size_type(2) << height) - 1 <= sorted.size()) {
+        height++;
+    }
+    std::vector<size_type> capacity(height + 1, 0);
+    for (size_type h = 1; h <= height; ++h) {
+        capacity[h] = capacity[h - 1] * 3 + 2;
+    }
+
+    nodes.reserve(sorted.size());
+    auto it = std::make_move_iterator(sorted.begin());
+    root = buildBalanced(it, sorted.size(), height, capacity);
+    optimize_layout();
+}
+
+template <typename T, typename Compare, typename Allocator>
+template <typename It>
+typename CompactTree<T, Compare, Allocator>::Index CompactTree<T, Compare, Allocator>::buildBalanced(It& it, size_type count, size_type height, const std::vector<size_type>& capacity) {
+    // В дереве высоты height от 2^height - 1 до 3^height - 1 ключей. Если дети-2-узлы
+    // не вмещают count, узел становится 3-узлом: черный с красным левым ребенком
+    if (count == 0) {
+        return NO_NODE;
+    }
+    size_type childCapacity = capacity[height - 1];
+    if (count <= 2 * childCapacity + 1) {
+        size_type leftCount = (count - 1) / 2;
+        Index left = buildBalanced(it, leftCount, height - 1, capacity);
+        Index node = makeNode(*it);
+        ++it;
+        nodes[node].setRed(false);
+        nodes[node].left = left;
+        Index right = buildBalanced(it, count - 1 - leftCount, height - 1, capacity);
+        nodes[node].setRight(right);
+        return node;
+    }
+
+    size_type rest = count - 2;
+    size_type firstCount = rest / 3;
+    size_type secondCount = (rest - firstCount) / 2;
+    Index first = buildBalanced(it, firstCount, height - 1, capacity);
+    Index redNode = makeNode(*it);
+    ++it;
+    nodes[redNode].left = first;
+    Index second = buildBalanced(it, secondCount, height - 1, capacity);
+    nodes[redNode].setRight(second);
+    Index node = makeNode(*it);
+    ++it;
+    nodes[node].setRed(false);
+    nodes[node].left = redNode;
+    Index third = buildBalanced(it, rest - firstCount - secondCount, height - 1, capacity);
+    nodes[node].setRight(third);
+    return node;
+}
+
+template <typename T, typename Compare, typename Allocator>
+template <typename... Args>
+typename CompactTree<T, Compare, Allocator>::Index CompactTree<T, Compare, Allocator>::makeNode(Args&&... args) {
+    if (nodes.size() >= NO_NODE) {
+        throw std::length_error("CompactTree is limited to 2^31 - 1 elements");
+    }
+    nodes.emplace_back(std::in_place, std::forward<Args>(args)...);
+    return static_cast<Index>(nodes.size() - 1);
+}
+
+template <typename T, typename Compare, typename Allocator>
+bool CompactTree<T, Compare, Allocator>::isRed(Index node) const {
+    return node != NO_NODE && nodes[node].red();
+}
+
+template <typename T, typename Compare, typename Allocator>
+std::pair<typename CompactTree<T, Compare, Allocator>::iterator, bool> CompactTree<T, Compare, Allocator>::insert(const T& value) {
+    return insertValue(value);
+}
+
+template <typename T, typename Compare, typename Allocator>
+std::pair<typename CompactTree<T, Compare, Allocator>::iterator, bool> CompactTree<T, Compare, Allocator>::insert(T&& value) {
+    return insertValue(std::move(value));
+}
+
+template <typename T, typename Compare, typename Allocator>
+template <typename... Args>
+std::pair<typename CompactTree<T, Compare, Allocator>::iterator, bool> CompactTree<T, Compare, Allocator>::emplace(Args&&... args) {
+    return insertValue(T(std::forward<Args>(args)...));
+}
+
+template <typename T, typename Compare, typename Allocator>
+template <typename V>
+std::pair<typename CompactTree<T, Compare, Allocator>::iterator, bool> CompactTree<T, Compare, Allocator>::insertValue(V&& value) {
+    // Повороты не двигают узлы в массиве: номер найденного или нового узла остается
+    // верным, а путь к нему после поворотов ищется заново
+    Index target = NO_NODE;
+    bool inserted = false;
+    root = insertAt(root, std::forward<V>(value), target, inserted);
+    nodes[root].setRed(false);
+    return {iterator(lowerBoundPath(nodes[target].val), this), inserted};
+}
+
+template <typename T, typename Compare, typename Allocator>
+template <typename V>
+typename CompactTree<T, Compare, Allocator>::Index CompactTree<T, Compare, Allocator>::insertAt(Index h, V&& value, Index& target, bool& inserted) {
+    if (h == NO_NODE) {
+        inserted = true;
+        target = makeNode(std::forward<V>(value));
+        return target;
+    }
+    // Массив может переехать при создании узла, поэтому ссылки на узлы не держим
+    if (comp(value, nodes[h].val)) {
+        Index left = insertAt(nodes[h].left, std::forward<V>(value), target, inserted);
+        nodes[h].left = left;
+    } else if (comp(nodes[h].val, value)) {
+        Index right = insertAt(nodes[h].right(), std::forward<V>(value), target, inserted);
+        nodes[h].setRight(right);
+    } else {
+        target = h;
+        return h;
+    }
+    return balance(h);
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename CompactTree<T, Compare, Allocator>::size_type CompactTree<T, Compare, Allocator>::erase(const T& value) {
+    if (!contains(value)) {
+        return 0;
+    }
+    if (!isRed(nodes[root].left) && !isRed(nodes[root].right())) {
+        nodes[root].setRed(true);
+    }
+    Index removed = NO_NODE;
+    root = eraseAt(root, value, removed);
+    if (root != NO_NODE) {
+        nodes[root].setRed(false);
+    }
+    relocateLast(removed);
+    return 1;
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename CompactTree<T, Compare, Allocator>::Index CompactTree<T, Compare, Allocator>::eraseAt(Index h, const T& key, Index& removed) {
+    if (comp(key, nodes[h].val)) {
+        if (!isRed(nodes[h].left) && !isRed(nodes[nodes[h].left].left)) {
+            h = moveRedLeft(h);
+        }
+        Index left = eraseAt(nodes[h].left, key, removed);
+        nodes[h].left = left;
+    } else {
+        if (isRed(nodes[h].left)) {
+            h = rotateRight(h);
+        }
+        if (!comp(nodes[h].val, key) && nodes[h].right() == NO_NODE) {
+            removed = h;
+            return NO_NODE;
+        }
+        if (!isRed(nodes[h].right()) && !isRed(nodes[nodes[h].right()].left)) {
+            h = moveRedRight(h);
+        }
+        if (!comp(nodes[h].val, key)) {
+            // Значение минимума правого поддерева переезжает сюда, удаляется узел минимума
+            Index successor = nodes[h].right();
+            while (nodes[successor].left != NO_NODE) {
+                successor = nodes[successor].left;
+            }
+            nodes[h].val = std::move(nodes[successor].val);
+            Index right = eraseMin(nodes[h].right(), removed);
+            nodes[h].setRight(right);
+        } else {
+            Index right = eraseAt(nodes[h].right(), key, removed);
+            nodes[h].setRight(right);
+        }
+    }
+    return balance(h);
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename CompactTree<T, Compare, Allocator>::Index CompactTree<T, Compare, Allocator>::eraseMin(Index h, Index& removed) {
+    if (nodes[h].left == NO_NODE) {
+        removed = h;
+        return NO_NODE;
+    }
+    if (!isRed(nodes[h].left) && !isRed(nodes[nodes[h].left].left)) {
+        h = moveRedLeft(h);
+    }
+    Index left = eraseMin(nodes[h].left, removed);
+    nodes[h].left = left;
+    return balance(h);
+}
+
+template <typename T, typename Compare, typename Allocator>
+void CompactTree<T, Compare, Allocator>::relocateLast(Index hole) {
+    Index last = static_cast<Index>(nodes.size() - 1);
+    if (hole != last) {
+        // Родителя нет, поэтому ссылку на последний узел находим спуском по его ключу
+        const T& key = nodes[last].val;
+        if (root == last) {
+            root = hole;
+        } else {
+            Index node = root;
+            while (true) {
+                Node& current = nodes[node];
+                Index next = comp(key, current.val) ? current.left : current.right();
+                if (next == last) {
+                    if (next == current.left) {
+                        current.left = hole;
+                    } else {
+                        current.setRight(hole);
+                    }
+                    break;
+                }
+                node = next;
+            }
+        }
+        nodes[hole] = std::move(nodes[last]);
+    }
+    nodes.pop_back();
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename CompactTree<T, Compare, Allocator>::Index CompactTree<T, Compare, Allocator>::rotateLeft(Index h) {
+    Index x = nodes[h].right();
+    nodes[h].setRight(nodes[x].left);
+    nodes[x].left = h;
+    nodes[x].setRed(nodes[h].red());
+    nodes[h].setRed(true);
+    return x;
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename CompactTree<T, Compare, Allocator>::Index CompactTree<T, Compare, Allocator>::rotateRight(Index h) {
+    Index x = nodes[h].left;
+    nodes[h].left = nodes[x].right();
+    nodes[x].setRight(h);
+    nodes[x].setRed(nodes[h].red());
+    nodes[h].setRed(true);
+    return x;
+}
+
+template <typename T, typename Compare, typename Allocator>
+void CompactTree<T, Compare, Allocator>::flipColors(Index h) {
+    Node& node = nodes[h];
+    node.setRed(!node.red());
+    nodes[node.left].setRed(!nodes[node.left].red());
+    nodes[node.right()].setRed(!nodes[node.right()].red());
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename CompactTree<T, Compare, Allocator>::Index CompactTree<T, Compare, Allocator>::balance(Index h) {
+    if (isRed(nodes[h].right()) && !isRed(nodes[h].left)) {
+        h = rotateLeft(h);
+    }
+    if (isRed(nodes[h].left) && isRed(nodes[nodes[h].left].left)) {
+        h = rotateRight(h);
+    }
+    if (isRed(nodes[h].left) && isRed(nodes[h].right())) {
+        flipColors(h);
+    }
+    return h;
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename CompactTree<T, Compare, Allocator>::Index CompactTree<T, Compare, Allocator>::moveRedLeft(Index h) {
+    flipColors(h);
+    if (isRed(nodes[nodes[h].right()].left)) {
+        nodes[h].setRight(rotateRight(nodes[h].right()));
+        h = rotateLeft(h);
+        flipColors(h);
+    }
+    return h;
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename CompactTree<T, Compare, Allocator>::Index CompactTree<T, Compare, Allocator>::moveRedRight(Index h) {
+    flipColors(h);
+    if (isRed(nodes[nodes[h].left].left)) {
+        h = rotateRight(h);
+        flipColors(h);
+    }
+    return h;
+}
+
+template <typename T, typename Compare, typename Allocator>
+std::vector<typename CompactTree<T, Compare, Allocator>::Index> CompactTree<T, Compare, Allocator>::lowerBoundPath(const T& key) const {
+    std::vector<Index> path;
+    size_type found = 0;
+    Index node = root;
+    while (node != NO_NODE) {
+        const Node& current = nodes[node];
+        path.push_back(node);
+        if (!comp(current.val, key)) {
+            found = path.size();
+            node = current.left;
+        } else {
+            node = current.right();
+        }
+    }
+    path.resize(found);
+    return path;
+}
+
+template <typename T, typename Compare, typename Allocator>
+std::vector<typename CompactTree<T, Compare, Allocator>::Index> CompactTree<T, Compare, Allocator>::upperBoundPath(const T& key) const {
+    std::vector<Index> path;
+    size_type found = 0;
+    Index node = root;
+    while (node != NO_NODE) {
+        const Node& current = nodes[node];
+        path.push_back(node);
+        if (comp(key, current.val)) {
+            found = path.size();
+            node = current.left;
+        } else {
+            node = current.right();
+        }
+    }
+    path.resize(found);
+    return path;
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename CompactTree<T, Compare, Allocator>::iterator CompactTree<T, Compare, Allocator>::find(const T& value) const {
+    std::vector<Index> path = lowerBoundPath(value);
+    if (path.empty() || comp(value, nodes[path.back()].val)) {
+        return end();
+    }
+    return iterator(std::move(path), this);
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename CompactTree<T, Compare, Allocator>::iterator CompactTree<T, Compare, Allocator>::lower_bound(const T& value) const {
+    return iterator(lowerBoundPath(value), this);
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename CompactTree<T, Compare, Allocator>::iterator CompactTree<T, Compare, Allocator>::upper_bound(const T& value) const {
+    return iterator(upperBoundPath(value), this);
+}
+
+template <typename T, typename Compare, typename Allocator>
+std::pair<typename CompactTree<T, Compare, Allocator>::iterator, typename CompactTree<T, Compare, Allocator>::iterator>
+CompactTree<T, Compare, Allocator>::equal_range(const T& value) const {
+    return {lower_bound(value), upper_bound(value)};
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename CompactTree<T, Compare, Allocator>::size_type CompactTree<T, Compare, Allocator>::count(const T& value) const {
+    return contains(value) ? 1 : 0;
+}
+
+template <typename T, typename Compare, typename Allocator>
+bool CompactTree<T, Compare, Allocator>::contains(const T& value) const {
+    // Спуск без пути: только номера узлов
+    Index node = root;
+    while (node != NO_NODE) {
+        const Node& current = nodes[node];
+        if (comp(value, current.val)) {
+            node = current.left;
+        } else if (comp(current.val, value)) {
+            node = current.right();
+        } else {
+            return true;
+        }
+    }
+    return false;
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename CompactTree<T, Compare, Allocator>::iterator CompactTree<T, Compare, Allocator>::begin() const {
+    return iterator::leftmost(this);
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename CompactTree<T, Compare, Allocator>::iterator CompactTree<T, Compare, Allocator>::end() const {
+    return iterator({}, this);
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename CompactTree<T, Compare, Allocator>::iterator CompactTree<T, Compare, Allocator>::cbegin() const {
+    return begin();
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename CompactTree<T, Compare, Allocator>::iterator CompactTree<T, Compare, Allocator>::cend() const {
+    return end();
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename CompactTree<T, Compare, Allocator>::size_type CompactTree<T, Compare, Allocator>::size() const {
+    return nodes.size();
+}
+
+template <typename T, typename Compare, typename Allocator>
+bool CompactTree<T, Compare, Allocator>::empty() const {
+    return nodes.empty();
+}
+
+template <typename T, typename Compare, typename Allocator>
+void CompactTree<T, Compare, Allocator>::clear() {
+    nodes.clear();
+    root = NO_NODE;
+}
+
+template <typename T, typename Compare, typename Allocator>
+void CompactTree<T, Compare, Allocator>::reserve(size_type count) {
+    nodes.reserve(count);
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename CompactTree<T, Compare, Allocator>::size_type CompactTree<T, Compare, Allocator>::memory_usage() const {
+    return nodes.capacity() * sizeof(Node);
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename CompactTree<T, Compare, Allocator>::allocator_type CompactTree<T, Compare, Allocator>::get_allocator() const {
+    return allocator_type(nodes.get_allocator());
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename CompactTree<T, Compare, Allocator>::key_compare CompactTree<T, Compare, Allocator>::key_comp() const {
+    return comp;
+}
+
+template <typename T, typename Compare, typename Allocator>
+void CompactTree<T, Compare, Allocator>::optimize_layout() {
+    if (root == NO_NODE) {
+        return;
+    }
+
+    // order - старые номера в порядке обхода в ширину, position - новый номер по старому
+    std::vector<Index> order;
+    order.reserve(nodes.size());
+    order.push_back(root);
+    for (size_type k = 0; k < order.size(); ++k) {
+        const Node& node = nodes[order[k]];
+        if (node.left != NO_NODE) {
+            order.push_back(node.left);
+        }
+        if (node.right() != NO_NODE) {
+            order.push_back(node.right());
+        }
+    }
+    std::vector<Index> position(nodes.size());
+    for (size_type k = 0; k < order.size(); ++k) {
+        position[order[k]] = static_cast<Index>(k);
+    }
+
+    std::vector<Node, NodeAllocator> relaid(nodes.get_allocator());
+    relaid.reserve(nodes.size());
+    for (Index old : order) {
+        relaid.push_back(std::move(nodes[old]));
+        Node& node = relaid.back();
+        if (node.left != NO_NODE) {
+            node.left = position[node.left];
+        }
+        if (node.right() != NO_NODE) {
+            node.setRight(position[node.right()]);
+        }
+    }
+    nodes.swap(relaid);
+    root = 0;
+}
+
+#endif // COMPACT_TREE_HPP
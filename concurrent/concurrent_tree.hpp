@@ -0,0 +1,486 @@
+#ifndef CONCURRENT_TREE_HPP
+#define CONCURRENT_TREE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+#include "epoch.hpp"
+#include "../persistent/cow_llrb.hpp"
+#include "../node_pool/node_pool.hpp"
+#include "../iterator/stack_iterator.hpp"
+
+// Дерево для многих читателей и писателей.
+// Опубликованные узлы никогда не меняются: запись копирует путь от корня до
+// измененного места (LLRB с копированием при записи) и публикует новый корень
+// атомарной заменой указателя. Поэтому читатели не берут блокировок: они закрепляют
+// эпоху, читают корень и спускаются по неизменяемой версии дерева.
+// Писатели выстраиваются в очередь на мьютексе; замененные узлы освобождаются
+// по эпохам, когда их уже не может видеть ни один читатель.
+// T должен быть копируемым: копирование пути копирует значения узлов.
+template <typename T, typename Compare = std::less<T>, typename Allocator = std::allocator<T>>
+class ConcurrentTree {
+private:
+    struct Node;
+
+public:
+    // Типы
+    using value_type = T;
+    using key_type = T;
+    using size_type = size_t;
+    using key_compare = Compare;
+    using value_compare = Compare;
+    using allocator_type = Allocator;
+    using difference_type = std::ptrdiff_t;
+
+    // Согласованная версия дерева для обхода и серии запросов.
+    // Пока снимок жив, его узлы не освобождаются; снимок не должен пережить дерево
+    class Snapshot {
+    public:
+        using iterator = StackIterator<Node, T>;
+        using const_iterator = iterator;
+
+        iterator begin() const;
+        iterator end() const;
+        iterator find(const T& value) const;
+        iterator lower_bound(const T& value) const;
+        iterator upper_bound(const T& value) const;
+        bool contains(const T& value) const;
+        bool empty() const;
+
+    private:
+        EpochManager::Guard guard;
+        const Node* root;
+        Compare comp;
+
+        Snapshot(EpochManager::Guard g, const Node* r, const Compare& c)
+            : guard(std::move(g)), root(r), comp(c) {}
+
+        friend class ConcurrentTree;
+    };
+
+    explicit ConcurrentTree(const Compare& comp = Compare(), const Allocator& alloc = Allocator());
+    template <typename InputIt>
+    ConcurrentTree(InputIt first, InputIt last, const Compare& comp = Compare(), const Allocator& alloc = Allocator());
+    ConcurrentTree(std::initializer_list<T> init, const Compare& comp = Compare(), const Allocator& alloc = Allocator());
+
+    ConcurrentTree(const ConcurrentTree&) = delete;
+    ConcurrentTree& operator=(const ConcurrentTree&) = delete;
+
+    ~ConcurrentTree();
+
+    // Чтение без блокировок; результат - копия значения
+    bool contains(const T& value) const;
+    std::optional<T> find(const T& value) const;
+    std::optional<T> lower_bound(const T& value) const;
+    std::optional<T> upper_bound(const T& value) const;
+    Snapshot snapshot() const;
+
+    // Число элементов в последней опубликованной версии
+    size_type size() const;
+    bool empty() const;
+
+    // Запись; писатели сериализуются
+    bool insert(const T& value);
+    bool insert(T&& value);
+    template <typename... Args>
+    bool emplace(Args&&... args);
+    size_type erase(const T& value);
+    void clear();
+
+    allocator_type get_allocator() const;
+    key_compare key_comp() const;
+
+private:
+    struct Node {
+        T val;
+        Node* left;
+        Node* right;
+        bool red;
+        std::uint64_t version;  // номер записи, создавшей узел
+
+        template <typename... Args>
+        explicit Node(std::uint64_t v, Args&&... args)
+            : val(std::forward<Args>(args)...), left(nullptr), right(nullptr), red(true), version(v) {}
+    };
+
+    using Llrb = persistent_detail::CowLlrb<Node, Compare>;
+
+    // Отложенные узлы проверяются пачками
+    static constexpr size_type RECLAIM_THRESHOLD = 256;
+
+    // Одна запись: узлы текущей записи изменяемы, остальные копируются
+    class Writer {
+    public:
+        explicit Writer(ConcurrentTree& t) : tree(t) {}
+
+        Node* own(Node* node);
+        template <typename V>
+        Node* make(V&& value);
+        void drop(Node* node);
+
+        void commit();
+        void rollback();
+
+        size_type replacedCount() const {
+            return replaced.size();
+        }
+
+    private:
+        ConcurrentTree& tree;
+        std::vector<Node*> created;    // новые узлы записи
+        std::vector<Node*> discarded;  // новые узлы, не попавшие в результат
+        std::vector<Node*> replaced;   // опубликованные узлы, исключенные записью
+    };
+
+    std::atomic<Node*> root;
+    std::atomic<size_type> count;
+    Compare comp;
+    NodePool<Node, Allocator> pool;
+
+    mutable EpochManager epochs;
+    std::mutex writeMutex;
+    std::uint64_t version;
+    std::vector<std::pair<std::uint64_t, Node*>> retired;
+
+    template <typename V>
+    bool insertValue(V&& value);
+    void publish(Writer& writer, Node* updated);
+    void destroyNode(Node* node);
+    void destroySubtree(Node* node);
+};
+
+// Реализация методов Snapshot
+
+template <typename T, typename Compare, typename Allocator>
+typename ConcurrentTree<T, Compare, Allocator>::Snapshot::iterator
+ConcurrentTree<T, Compare, Allocator>::Snapshot::begin() const {
+    return iterator::leftmost(root);
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename ConcurrentTree<T, Compare, Allocator>::Snapshot::iterator
+ConcurrentTree<T, Compare, Allocator>::Snapshot::end() const {
+    return iterator();
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename ConcurrentTree<T, Compare, Allocator>::Snapshot::iterator
+ConcurrentTree<T, Compare, Allocator>::Snapshot::find(const T& value) const {
+    iterator it = lower_bound(value);
+    return it != end() && !comp(value, *it) ? it : end();
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename ConcurrentTree<T, Compare, Allocator>::Snapshot::iterator
+ConcurrentTree<T, Compare, Allocator>::Snapshot::lower_bound(const T& value) const {
+    // В стеке остаются узлы, от которых спуск ушел влево: это следующие элементы
+    std::vector<const Node*> path;
+    for (const Node* node = root; node != nullptr;) {
+        if (!comp(node->val, value)) {
+            path.push_back(node);
+            node = node->left;
+        } else {
+            node = node->right;
+        }
+    }
+    return iterator(std::move(path));
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename ConcurrentTree<T, Compare, Allocator>::Snapshot::iterator
+ConcurrentTree<T, Compare, Allocator>::Snapshot::upper_bound(const T& value) const {
+    std::vector<const Node*> path;
+    for (const Node* node = root; node != nullptr;) {
+        if (comp(value, node->val)) {
+            path.push_back(node);
+            node = node->left;
+        } else {
+            node = node->right;
+        }
+    }
+    return iterator(std::move(path));
+}
+
+template <typename T, typename Compare, typename Allocator>
+bool ConcurrentTree<T, Compare, Allocator>::Snapshot::contains(const T& value) const {
+    return Llrb::find(root, value, comp) != nullptr;
+}
+
+template <typename T, typename Compare, typename Allocator>
+bool ConcurrentTree<T, Compare, Allocator>::Snapshot::empty() const {
+    return root == nullptr;
+}
+
+// Реализация методов Writer
+
+template <typename T, typename Compare, typename Allocator>
+typename ConcurrentTree<T, Compare, Allocator>::Node*
+ConcurrentTree<T, Compare, Allocator>::Writer::own(Node* node) {
+    if (node->version == tree.version) {
+        return node;
+    }
+    Node* copy = make(node->val);
+    copy->left = node->left;
+    copy->right = node->right;
+    copy->red = node->red;
+    replaced.push_back(node);
+    return copy;
+}
+
+template <typename T, typename Compare, typename Allocator>
+template <typename V>
+typename ConcurrentTree<T, Compare, Allocator>::Node*
+ConcurrentTree<T, Compare, Allocator>::Writer::make(V&& value) {
+    // Место под номер узла - заранее и с запасом: push_back после create не бросает,
+    // а перевыделение не повторяется на каждом узле пути
+    if (created.size() == created.capacity()) {
+        created.reserve(2 * created.capacity() + 16);
+    }
+    Node* node = tree.pool.create(tree.version, std::forward<V>(value));
+    created.push_back(node);
+    return node;
+}
+
+template <typename T, typename Compare, typename Allocator>
+void ConcurrentTree<T, Compare, Allocator>::Writer::drop(Node* node) {
+    if (node->version == tree.version) {
+        discarded.push_back(node);
+    } else {
+        replaced.push_back(node);
+    }
+}
+
+template <typename T, typename Compare, typename Allocator>
+void ConcurrentTree<T, Compare, Allocator>::Writer::commit() {
+    // Новые узлы вне результата никто не видел; старые ждут ухода читателей
+    for (Node* node : discarded) {
+        tree.destroyNode(node);
+    }
+    std::uint64_t epoch = tree.epochs.current();
+    for (Node* node : replaced) {
+        tree.retired.emplace_back(epoch, node);
+    }
+    tree.version++;
+    if (tree.retired.size() >= RECLAIM_THRESHOLD) {
+        tree.epochs.reclaim(tree.retired, [this](Node* node) { tree.destroyNode(node); });
+    }
+}
+
+template <typename T, typename Compare, typename Allocator>
+void ConcurrentTree<T, Compare, Allocator>::Writer::rollback() {
+    // Опубликованная версия не тронута, достаточно удалить новые узлы
+    for (Node* node : created) {
+        tree.destroyNode(node);
+    }
+    tree.version++;
+}
+
+// Реализация методов ConcurrentTree
+
+template <typename T, typename Compare, typename Allocator>
+ConcurrentTree<T, Compare, Allocator>::ConcurrentTree(const Compare& comp, const Allocator& alloc)
+    : root(nullptr), count(0), comp(comp), pool(alloc), version(1) {}
+
+template <typename T, typename Compare, typename Allocator>
+template <typename InputIt>
+ConcurrentTree<T, Compare, Allocator>::ConcurrentTree(InputIt first, InputIt last, const Compare& comp,
+                                                      const Allocator& alloc)
+    : ConcurrentTree(comp, alloc) {
+    for (; first != last; ++first) {
+        insert(*first);
+    }
+}
+
+template <typename T, typename Compare, typename Allocator>
+ConcurrentTree<T, Compare, Allocator>::ConcurrentTree(std::initializer_list<T> init, const Compare& comp,
+                                                      const Allocator& alloc)
+    : ConcurrentTree(init.begin(), init.end(), comp, alloc) {}
+
+template <typename T, typename Compare, typename Allocator>
+ConcurrentTree<T, Compare, Allocator>::~ConcurrentTree() {
+    destroySubtree(root.load());
+    for (auto& entry : retired) {
+        destroyNode(entry.second);
+    }
+}
+
+template <typename T, typename Compare, typename Allocator>
+bool ConcurrentTree<T, Compare, Allocator>::contains(const T& value) const {
+    EpochManager::Guard guard = epochs.pin();
+    return Llrb::find(root.load(), value, comp) != nullptr;
+}
+
+template <typename T, typename Compare, typename Allocator>
+std::optional<T> ConcurrentTree<T, Compare, Allocator>::find(const T& value) const {
+    EpochManager::Guard guard = epochs.pin();
+    const Node* node = Llrb::find(root.load(), value, comp);
+    return node != nullptr ? std::optional<T>(node->val) : std::nullopt;
+}
+
+template <typename T, typename Compare, typename Allocator>
+std::optional<T> ConcurrentTree<T, Compare, Allocator>::lower_bound(const T& value) const {
+    EpochManager::Guard guard = epochs.pin();
+    const Node* node = Llrb::lowerBound(root.load(), value, comp);
+    return node != nullptr ? std::optional<T>(node->val) : std::nullopt;
+}
+
+template <typename T, typename Compare, typename Allocator>
+std::optional<T> ConcurrentTree<T, Compare, Allocator>::upper_bound(const T& value) const {
+    EpochManager::Guard guard = epochs.pin();
+    const Node* node = Llrb::upperBound(root.load(), value, comp);
+    return node != nullptr ? std::optional<T>(node->val) : std::nullopt;
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename ConcurrentTree<T, Compare, Allocator>::Snapshot ConcurrentTree<T, Compare, Allocator>::snapshot() const {
+    // Эпоха закрепляется до чтения корня
+    EpochManager::Guard guard = epochs.pin();
+    const Node* current = root.load();
+    return Snapshot(std::move(guard), current, comp);
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename ConcurrentTree<T, Compare, Allocator>::size_type ConcurrentTree<T, Compare, Allocator>::size() const {
+    return count.load(std::memory_order_relaxed);
+}
+
+template <typename T, typename Compare, typename Allocator>
+bool ConcurrentTree<T, Compare, Allocator>::empty() const {
+    return root.load() == nullptr;
+}
+
+template <typename T, typename Compare, typename Allocator>
+bool ConcurrentTree<T, Compare, Allocator>::insert(const T& value) {
+    return insertValue(value);
+}
+
+template <typename T, typename Compare, typename Allocator>
+bool ConcurrentTree<T, Compare, Allocator>::insert(T&& value) {
+    return insertValue(std::move(value));
+}
+
+template <typename T, typename Compare, typename Allocator>
+template <typename... Args>
+bool ConcurrentTree<T, Compare, Allocator>::emplace(Args&&... args) {
+    return insertValue(T(std::forward<Args>(args)...));
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename ConcurrentTree<T, Compare, Allocator>::size_type ConcurrentTree<T, Compare, Allocator>::erase(const T& value) {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    Node* current = root.load(std::memory_order_relaxed);
+    if (Llrb::find(current, value, comp) == nullptr) {
+        return 0;
+    }
+    Writer writer(*this);
+    Node* updated;
+    try {
+        updated = Llrb::erase(writer, current, value, comp);
+    } catch (...) {
+        writer.rollback();
+        throw;
+    }
+    publish(writer, updated);
+    count.fetch_sub(1, std::memory_order_relaxed);
+    return 1;
+}
+
+template <typename T, typename Compare, typename Allocator>
+void ConcurrentTree<T, Compare, Allocator>::clear() {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    Node* current = root.load(std::memory_order_relaxed);
+    if (current == nullptr) {
+        return;
+    }
+    // Все узлы старой версии уходят в отложенные
+    Writer writer(*this);
+    std::vector<Node*> stack{current};
+    while (!stack.empty()) {
+        Node* node = stack.back();
+        stack.pop_back();
+        if (node->left != nullptr) {
+            stack.push_back(node->left);
+        }
+        if (node->right != nullptr) {
+            stack.push_back(node->right);
+        }
+        writer.drop(node);
+    }
+    publish(writer, nullptr);
+    count.store(0, std::memory_order_relaxed);
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename ConcurrentTree<T, Compare, Allocator>::allocator_type ConcurrentTree<T, Compare, Allocator>::get_allocator() const {
+    return allocator_type(pool.get_allocator());
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename ConcurrentTree<T, Compare, Allocator>::key_compare ConcurrentTree<T, Compare, Allocator>::key_comp() const {
+    return comp;
+}
+
+// Вспомогательные методы
+
+template <typename T, typename Compare, typename Allocator>
+template <typename V>
+bool ConcurrentTree<T, Compare, Allocator>::insertValue(V&& value) {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    Node* current = root.load(std::memory_order_relaxed);
+    if (Llrb::find(current, value, comp) != nullptr) {
+        return false;
+    }
+    Writer writer(*this);
+    Node* updated;
+    try {
+        updated = Llrb::insert(writer, current, std::forward<V>(value), comp);
+    } catch (...) {
+        writer.rollback();
+        throw;
+    }
+    publish(writer, updated);
+    count.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+template <typename T, typename Compare, typename Allocator>
+void ConcurrentTree<T, Compare, Allocator>::publish(Writer& writer, Node* updated) {
+    // Узлы новой версии заполнены до публикации корня; эпоха для
+    // отложенных узлов читается после нее
+    retired.reserve(retired.size() + writer.replacedCount());
+    root.store(updated);
+    writer.commit();
+}
+
+template <typename T, typename Compare, typename Allocator>
+void ConcurrentTree<T, Compare, Allocator>::destroyNode(Node* node) {
+    pool.destroy(node);
+}
+
+template <typename T, typename Compare, typename Allocator>
+void ConcurrentTree<T, Compare, Allocator>::destroySubtree(Node* node) {
+    std::vector<Node*> stack;
+    if (node != nullptr) {
+        stack.push_back(node);
+    }
+    while (!stack.empty()) {
+        Node* current = stack.back();
+        stack.pop_back();
+        if (current->left != nullptr) {
+            stack.push_back(current->left);
+        }
+        if (current->right != nullptr) {
+            stack.push_back(current->right);
+        }
+        destroyNode(current);
+    }
+}
+
+#endif // CONCURRENT_TREE_HPP
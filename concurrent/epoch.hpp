@@ -0,0 +1,111 @@
+#ifndef EPOCH_HPP
+#define EPOCH_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Освобождение памяти по эпохам (epoch-based reclamation).
+// Читатель на время обхода занимает слот и записывает в него текущую эпоху.
+// Писатель откладывает удаленные узлы с пометкой эпохи и освобождает их, только
+// когда все занятые слоты ушли в более позднюю эпоху: значит, ни один читатель
+// уже не может держать указатель на такой узел.
+class EpochManager {
+public:
+    static constexpr std::size_t SLOT_COUNT = 128;
+
+    // Закрепление эпохи читателем; слот освобождается в деструкторе
+    class Guard {
+    public:
+        Guard() : slot(nullptr) {}
+        explicit Guard(std::atomic<std::uint64_t>* s) : slot(s) {}
+        Guard(Guard&& other) noexcept : slot(std::exchange(other.slot, nullptr)) {}
+
+        Guard& operator=(Guard&& other) noexcept {
+            if (this != &other) {
+                unpin();
+                slot = std::exchange(other.slot, nullptr);
+            }
+            return *this;
+        }
+
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+
+        ~Guard() {
+            unpin();
+        }
+
+    private:
+        std::atomic<std::uint64_t>* slot;
+
+        void unpin() {
+            if (slot != nullptr) {
+                slot->store(0, std::memory_order_release);
+                slot = nullptr;
+            }
+        }
+    };
+
+    EpochManager() : globalEpoch(1) {}
+
+    EpochManager(const EpochManager&) = delete;
+    EpochManager& operator=(const EpochManager&) = delete;
+
+    // Вход читателя. Свободный слот ищется начиная с позиции потока
+    Guard pin() const {
+        std::size_t index = std::hash<std::thread::id>()(std::this_thread::get_id()) % SLOT_COUNT;
+        while (true) {
+            std::uint64_t expected = 0;
+            std::uint64_t epoch = globalEpoch.load(std::memory_order_seq_cst);
+            if (slots[index].epoch.compare_exchange_strong(expected, epoch, std::memory_order_seq_cst)) {
+                return Guard(&slots[index].epoch);
+            }
+            index = (index + 1) % SLOT_COUNT;
+        }
+    }
+
+    // Эпоха, которой помечается узел, только что исключенный из опубликованного дерева
+    std::uint64_t current() const {
+        return globalEpoch.load(std::memory_order_seq_cst);
+    }
+
+    // Сдвигает эпоху и освобождает отложенные узлы, недоступные ни одному читателю.
+    // Вызывается только писателем
+    template <typename P, typename Free>
+    void reclaim(std::vector<std::pair<std::uint64_t, P>>& retired, Free free) {
+        globalEpoch.fetch_add(1, std::memory_order_seq_cst);
+        std::uint64_t oldest = std::numeric_limits<std::uint64_t>::max();
+        for (const Slot& slot : slots) {
+            std::uint64_t epoch = slot.epoch.load(std::memory_order_seq_cst);
+            if (epoch != 0 && epoch < oldest) {
+                oldest = epoch;
+            }
+        }
+        std::size_t kept = 0;
+        for (auto& entry : retired) {
+            if (entry.first < oldest) {
+                free(entry.second);
+            } else {
+                retired[kept++] = entry;
+            }
+        }
+        retired.resize(kept);
+    }
+
+private:
+    // Слоты разнесены по строкам кеша, чтобы читатели не мешали друг другу
+    struct alignas(64) Slot {
+        std::atomic<std::uint64_t> epoch{0};
+    };
+
+    mutable Slot slots[SLOT_COUNT];
+    std::atomic<std::uint64_t> globalEpoch;
+};
+
+#endif // EPOCH_HPP
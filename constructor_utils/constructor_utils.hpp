@@ -2,13 +2,21 @@
 #define CONSTRUCTOR_UTILS_HPP
 
 #include "../tree/tree.hpp"
+#include "../snapshot/snapshot_file.hpp"
+#include "../snapshot/mapped_tree.hpp"
+#include "../parallel/thread_pool.hpp"
+#include <charconv>
+#include <cstring>
 #include <string>
 #include <string_view>
 #include <fstream>
 #include <sstream>
 #include <map>
 #include <set>
+#include <unordered_map>
+#include <unordered_set>
 #include <functional>
+#include <type_traits>
 #include <vector>
 #include <iostream>
 #include <stdexcept>
@@ -22,7 +30,34 @@ public:
     // 5 2 7
     // 2 1 3
     // 7 6 8
-    static Tree<T> fromEdgeList(std::string_view filename);
+    // Файл отображается в память и для целых T разбирается std::from_chars,
+    // большие файлы - параллельно кусками по границам строк.
+    // preserveShape = true связывает узлы так, как описано в файле, за O(n) и только
+    // раскрашивает их; если описание не дерево поиска или не раскрашивается, дерево
+    // строится сбалансированным, как без флага
+    static Tree<T> fromEdgeList(std::string_view filename, bool preserveShape = false);
+    
+    // Запись в том же формате, корень первой строкой; отсутствующий ребенок - T{}.
+    // Обход в прямом порядке по ссылкам на родителя, вывод копится в большом буфере
+    template <typename Compare, typename Allocator, typename Augment, typename Links>
+    static void toEdgeList(const Tree<T, Compare, Allocator, Augment, Links>& tree, std::string_view filename);
+    
+    // Бинарный снимок (только для тривиально копируемых T): заголовок с версией,
+    // размером элемента, меткой компаратора и контрольной суммой, затем элементы в порядке дерева.
+    // load и openMapped должны получить тот же Compare, иначе бросают исключение
+    template <typename Compare, typename Allocator, typename Augment, typename Links>
+    static void save(const Tree<T, Compare, Allocator, Augment, Links>& tree, std::string_view filename);
+    
+    // Дерево из снимка за O(n) через построение из отсортированного диапазона
+    template <typename Compare = std::less<T>, typename Allocator = std::allocator<T>,
+              typename Augment = NoAugment, typename Links = PlainLinks>
+    static Tree<T, Compare, Allocator, Augment, Links> load(std::string_view filename, const Compare& comp = Compare(),
+                                                            const Allocator& alloc = Allocator());
+    
+    // Запросы прямо к отображенному в память снимку, без разбора и копирования.
+    // verify = false пропускает проход по данным для проверки контрольной суммы
+    template <typename Compare = std::less<T>>
+    static MappedTree<T, Compare> openMapped(std::string_view filename, bool verify = true, const Compare& comp = Compare());
     
 private:
     struct EdgeData {
@@ -31,61 +66,139 @@ private:
         T right;
     };
     
+    // Результат разбора куска файла: ребра и некорректные строки в порядке файла
+    struct ParsedChunk {
+        std::vector<EdgeData> edges;
+        std::vector<std::string> invalid;
+    };
+    
+    // Куски меньше этого размера разбираются в одном потоке
+    static constexpr size_t PARSE_CHUNK_BYTES = size_t(1) << 20;
+    // Размер буфера записи toEdgeList
+    static constexpr size_t EXPORT_BUFFER_BYTES = size_t(1) << 20;
+    
+    template <typename U, typename = void>
+    struct IsHashable : std::false_type {};
+    
+    template <typename U>
+    struct IsHashable<U, std::void_t<decltype(std::hash<U>{}(std::declval<const U&>()))>> : std::true_type {};
+    
+    // Хеш-таблицы, если для T есть std::hash, иначе упорядоченные контейнеры
+    template <typename V>
+    using EdgeMap = std::conditional_t<IsHashable<T>::value, std::unordered_map<T, V>, std::map<T, V>>;
+    using EdgeSet = std::conditional_t<IsHashable<T>::value, std::unordered_set<T>, std::set<T>>;
+    
     static std::vector<EdgeData> parseEdgeList(std::string_view filename);
+    static ParsedChunk parseChunk(const char* first, const char* last, size_t depth);
+    static bool parseLine(const char* first, const char* last, EdgeData& edge);
+    static void appendValue(std::string& buffer, const T& value);
 };
 
 template <typename T>
-std::vector<typename ConstructorsUtil<T>::EdgeData> ConstructorsUtil<T>::parseEdgeList(std::string_view filename) {
-    std::vector<EdgeData> edges;
-    std::string filenameStr(filename);
-    std::ifstream file(filenameStr);
-    
-    if (!file.is_open()) {
-        throw std::runtime_error("Cannot open file: " + filenameStr);
+bool ConstructorsUtil<T>::parseLine(const char* first, const char* last, EdgeData& edge) {
+    if constexpr (std::is_integral<T>::value && !std::is_same<T, bool>::value) {
+        // Целые разбираются std::from_chars прямо из отображения, без копий строки
+        T* fields[] = {&edge.value, &edge.left, &edge.right};
+        for (T* field : fields) {
+            while (first != last && (*first == ' ' || *first == '\t')) {
+                ++first;
+            }
+            auto result = std::from_chars(first, last, *field);
+            if (result.ec != std::errc()) {
+                return false;
+            }
+            first = result.ptr;
+        }
+        return true;
+    } else {
+        std::istringstream iss(std::string(first, last));
+        return static_cast<bool>(iss >> edge.value >> edge.left >> edge.right);
+    }
+}
+
+template <typename T>
+typename ConstructorsUtil<T>::ParsedChunk ConstructorsUtil<T>::parseChunk(const char* first, const char* last, size_t depth) {
+    ThreadPool& threads = ThreadPool::instance();
+    if (static_cast<size_t>(last - first) > PARSE_CHUNK_BYTES && depth < threads.parallelDepth()) {
+        // Делим по ближайшему к середине концу строки, половины разбираются параллельно
+        const char* middle = first + (last - first) / 2;
+        const char* newline = static_cast<const char*>(std::memchr(middle, '\n', static_cast<size_t>(last - middle)));
+        if (newline != nullptr) {
+            middle = newline + 1;
+            ParsedChunk left;
+            ParsedChunk right;
+            threads.invoke([&] { right = parseChunk(middle, last, depth + 1); },
+                           [&] { left = parseChunk(first, middle, depth + 1); });
+            left.edges.insert(left.edges.end(), right.edges.begin(), right.edges.end());
+            left.invalid.insert(left.invalid.end(), right.invalid.begin(), right.invalid.end());
+            return left;
+        }
     }
     
-    std::string line;
-    while (std::getline(file, line)) {
-        if (line.empty() || line[0] == '#') {
-            continue; // Пропускаем пустые строки и комментарии
+    ParsedChunk chunk;
+    while (first != last) {
+        const char* lineEnd = static_cast<const char*>(std::memchr(first, '\n', static_cast<size_t>(last - first)));
+        const char* next = lineEnd != nullptr ? lineEnd + 1 : last;
+        if (lineEnd == nullptr) {
+            lineEnd = last;
+        }
+        if (lineEnd != first && lineEnd[-1] == '\r') {
+            --lineEnd;
         }
         
-        std::istringstream iss(line);
-        EdgeData edge;
-        
-        if (iss >> edge.value >> edge.left >> edge.right) {
-            edges.push_back(edge);
-        } else {
-            std::cerr << "Warning: Invalid line format: " << line << std::endl;
+        // Пропускаем пустые строки и комментарии
+        if (lineEnd != first && *first != '#') {
+            EdgeData edge;
+            if (parseLine(first, lineEnd, edge)) {
+                chunk.edges.push_back(edge);
+            } else {
+                chunk.invalid.emplace_back(first, lineEnd);
+            }
         }
+        first = next;
+    }
+    return chunk;
+}
+
+template <typename T>
+std::vector<typename ConstructorsUtil<T>::EdgeData> ConstructorsUtil<T>::parseEdgeList(std::string_view filename) {
+    // Файл отображается в память целиком и разбирается кусками без построчного чтения
+    std::string filenameStr(filename);
+    snapshot_detail::MappedFile file(filenameStr);
+    if (file.size() == 0) {
+        return {};
     }
     
-    file.close();
-    return edges;
+    const char* text = reinterpret_cast<const char*>(file.data());
+    ParsedChunk parsed = parseChunk(text, text + file.size(), 0);
+    for (const auto& line : parsed.invalid) {
+        std::cerr << "Warning: Invalid line format: " << line << std::endl;
+    }
+    return std::move(parsed.edges);
 }
 
 template <typename T>
-Tree<T> ConstructorsUtil<T>::fromEdgeList(std::string_view filename) {
-    Tree<T> tree;
+Tree<T> ConstructorsUtil<T>::fromEdgeList(std::string_view filename, bool preserveShape) {
     std::vector<EdgeData> edges = parseEdgeList(filename);
     
     if (edges.empty()) {
-        return tree;
+        return Tree<T>();
     }
     
-    // Создаем карту связей: значение -> (левое, правое)
-    std::map<T, std::pair<T, T>> connections;
-    for (const auto& edge : edges) {
-        connections[edge.value] = {edge.left, edge.right};
+    // Создаем карту связей: значение -> (левое, правое); при повторах побеждает последняя строка
+    EdgeMap<std::pair<T, T>> connections;
+    EdgeSet children;
+    if constexpr (IsHashable<T>::value) {
+        connections.reserve(edges.size());
+        children.reserve(edges.size() * 2);
     }
-    
-    // Находим корень (узел, который не является потомком)
-    std::set<T> children;
     for (const auto& edge : edges) {
+        connections[edge.value] = {edge.left, edge.right};
         if (edge.left != T{}) children.insert(edge.left);
         if (edge.right != T{}) children.insert(edge.right);
     }
     
+    // Находим корень (узел, который не является потомком)
     T rootValue = T{};
     for (const auto& edge : edges) {
         if (children.find(edge.value) == children.end()) {
@@ -94,28 +207,148 @@ Tree<T> ConstructorsUtil<T>::fromEdgeList(std::string_view filename) {
         }
     }
     
-    if (rootValue == T{} && !edges.empty()) {
+    if (rootValue == T{}) {
         rootValue = edges[0].value;
     }
     
-    // Рекурсивно строим дерево
-    std::function<void(T)> buildTree = [&](T val) {
-        if (val == T{}) return;
-        
-        tree.insert(val);
+    // Собираем достижимые из корня значения обходом с явным стеком: глубина
+    // входного дерева не ограничена стеком вызовов. Посещенные связи удаляются,
+    // поэтому циклы во входе не зацикливают обход. Родитель получает номер раньше
+    // детей, links хранит номера детей для построения с сохранением формы
+    constexpr size_t noChild = Tree<T>::noChild;
+    std::vector<T> values;
+    std::vector<std::pair<size_t, size_t>> links;
+    values.reserve(connections.size());
+    links.reserve(connections.size());
+    struct Pending {
+        T value;
+        size_t parent;
+        bool isLeft;
+    };
+    std::vector<Pending> pending{{rootValue, noChild, false}};
+    while (!pending.empty()) {
+        Pending top = std::move(pending.back());
+        pending.pop_back();
+        if (top.value == T{}) continue;
         
-        auto it = connections.find(val);
+        size_t index = values.size();
+        if (top.parent != noChild) {
+            (top.isLeft ? links[top.parent].first : links[top.parent].second) = index;
+        }
+        links.emplace_back(noChild, noChild);
+        auto it = connections.find(top.value);
         if (it != connections.end()) {
-            buildTree(it->second.first);
-            buildTree(it->second.second);
+            pending.push_back({it->second.second, index, false});
+            pending.push_back({it->second.first, index, true});
+            connections.erase(it);
         }
-    };
+        values.push_back(std::move(top.value));
+    }
+    
+    if (preserveShape) {
+        Tree<T> tree;
+        if (tree.assignShape(values, links)) {
+            return tree;
+        }
+    }
+    
+    // Сортировка и построение за O(n) вместо вставок по одной
+    return Tree<T>(values.begin(), values.end());
+}
+
+template <typename T>
+void ConstructorsUtil<T>::appendValue(std::string& buffer, const T& value) {
+    if constexpr (std::is_integral<T>::value && !std::is_same<T, bool>::value) {
+        char digits[24];
+        auto result = std::to_chars(digits, digits + sizeof(digits), value);
+        buffer.append(digits, result.ptr);
+    } else {
+        std::ostringstream oss;
+        oss << value;
+        buffer += oss.str();
+    }
+}
+
+template <typename T>
+template <typename Compare, typename Allocator, typename Augment, typename Links>
+void ConstructorsUtil<T>::toEdgeList(const Tree<T, Compare, Allocator, Augment, Links>& tree, std::string_view filename) {
+    using Node = typename Tree<T, Compare, Allocator, Augment, Links>::Node;
+    
+    std::string filenameStr(filename);
+    std::ofstream file(filenameStr, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        throw std::runtime_error("Cannot open file: " + filenameStr);
+    }
     
-    if (rootValue != T{}) {
-        buildTree(rootValue);
+    std::string buffer;
+    buffer.reserve(EXPORT_BUFFER_BYTES + 256);
+    const T none{};
+    const Node* nil = tree.nil;
+    const Node* node = tree.root;
+    while (node != nil) {
+        // T{} в формате означает отсутствие ребенка, такое значение не восстановится при чтении
+        if (node->val == none) {
+            throw std::runtime_error("Edge list cannot hold the value T{}: " + filenameStr);
+        }
+        appendValue(buffer, node->val);
+        buffer += ' ';
+        appendValue(buffer, node->left != nil ? node->left->val : none);
+        buffer += ' ';
+        appendValue(buffer, node->right != nil ? node->right->val : none);
+        buffer += '\n';
+        if (buffer.size() >= EXPORT_BUFFER_BYTES) {
+            file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            buffer.clear();
+        }
+        
+        // Следующий в прямом порядке: левый ребенок, иначе правый, иначе правый ребенок
+        // ближайшего предка, из левого поддерева которого мы поднимаемся
+        if (node->left != nil) {
+            node = node->left;
+        } else if (node->right != nil) {
+            node = node->right;
+        } else {
+            const Node* parent = node->parent;
+            while (parent != nil && (node == parent->right || parent->right == nil)) {
+                node = parent;
+                parent = parent->parent;
+            }
+            node = parent == nil ? nil : parent->right;
+        }
     }
     
-    return tree;
+    file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    file.flush();
+    if (!file) {
+        throw std::runtime_error("Cannot write edge list: " + filenameStr);
+    }
+}
+
+template <typename T>
+template <typename Compare, typename Allocator, typename Augment, typename Links>
+void ConstructorsUtil<T>::save(const Tree<T, Compare, Allocator, Augment, Links>& tree, std::string_view filename) {
+    snapshot_detail::writeSnapshot<T, Compare>(std::string(filename), tree.begin(), tree.size());
+}
+
+template <typename T>
+template <typename Compare, typename Allocator, typename Augment, typename Links>
+Tree<T, Compare, Allocator, Augment, Links> ConstructorsUtil<T>::load(std::string_view filename, const Compare& comp,
+                                                                     const Allocator& alloc) {
+    std::string filenameStr(filename);
+    snapshot_detail::MappedFile file(filenameStr);
+    size_t count = 0;
+    const T* values = snapshot_detail::validateSnapshot<T, Compare>(file, filenameStr, count, true);
+    return Tree<T, Compare, Allocator, Augment, Links>(values, values + count, comp, alloc);
+}
+
+template <typename T>
+template <typename Compare>
+MappedTree<T, Compare> ConstructorsUtil<T>::openMapped(std::string_view filename, bool verify, const Compare& comp) {
+    std::string filenameStr(filename);
+    auto file = std::make_shared<const snapshot_detail::MappedFile>(filenameStr);
+    size_t count = 0;
+    const T* values = snapshot_detail::validateSnapshot<T, Compare>(*file, filenameStr, count, verify);
+    return MappedTree<T, Compare>(std::move(file), values, count, comp);
 }
 
 #endif // CONSTRUCTOR_UTILS_HPP
@@ -0,0 +1,354 @@
+#ifndef FROZEN_TREE_HPP
+#define FROZEN_TREE_HPP
+
+#include <cstddef>
+#include <utility>
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <vector>
+#include <functional>
+#include "../tree/prefetch.hpp"
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace frozen_detail {
+
+// Число младших нулевых битов; x != 0
+inline unsigned countTrailingZeros(std::size_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<unsigned>(__builtin_ctzll(static_cast<unsigned long long>(x)));
+#elif defined(_MSC_VER) && defined(_WIN64)
+    unsigned long index;
+    _BitScanForward64(&index, x);
+    return static_cast<unsigned>(index);
+#else
+    unsigned n = 0;
+    while ((x & 1) == 0) {
+        x >>= 1;
+        n++;
+    }
+    return n;
+#endif
+}
+
+} // namespace frozen_detail
+
+// Предварительное объявление для итератора
+template <typename FrozenT>
+class FrozenIterator;
+
+// Неизменяемый снимок дерева в раскладке Эйтцингера: ключи лежат в одном
+// массиве в порядке обхода в ширину, дети элемента k - элементы 2k и 2k+1 (с единицы).
+// Спуск идет без ветвлений и заранее подгружает кэш-линию с потомками на несколько
+// уровней ниже, поэтому частые запросы к редко меняющемуся набору не ждут памяти.
+// Строится за O(n) из отсортированной последовательности уникальных ключей (Tree::freeze).
+template <typename T, typename Compare = std::less<T>, typename Allocator = std::allocator<T>>
+class FrozenTree {
+public:
+    // Типы
+    using iterator = FrozenIterator<FrozenTree>;
+    using const_iterator = iterator;
+    using value_type = T;
+    using key_type = T;
+    using size_type = size_t;
+    using key_compare = Compare;
+    using value_compare = Compare;
+    using allocator_type = Allocator;
+    using difference_type = std::ptrdiff_t;
+
+    explicit FrozenTree(const Compare& comp = Compare(), const Allocator& alloc = Allocator());
+    // first..first+count - отсортированные по comp уникальные ключи
+    template <typename InputIt>
+    FrozenTree(InputIt first, size_type count, const Compare& comp = Compare(), const Allocator& alloc = Allocator());
+
+    // Поиск без ветвлений за O(log n)
+    iterator find(const T& value) const;
+    iterator lower_bound(const T& value) const;
+    iterator upper_bound(const T& value) const;
+    std::pair<iterator, iterator> equal_range(const T& value) const;
+    size_type count(const T& value) const;
+    bool contains(const T& value) const;
+
+    // Гетерогенный поиск (только для прозрачных компараторов)
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    iterator find(const K& key) const;
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    iterator lower_bound(const K& key) const;
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    iterator upper_bound(const K& key) const;
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    std::pair<iterator, iterator> equal_range(const K& key) const;
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    size_type count(const K& key) const;
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    bool contains(const K& key) const;
+
+    // Обход в порядке возрастания
+    iterator begin() const;
+    iterator end() const;
+    iterator cbegin() const;
+    iterator cend() const;
+
+    // Информация о снимке
+    size_type size() const;
+    bool empty() const;
+    allocator_type get_allocator() const;
+    key_compare key_comp() const;
+
+private:
+    // Сколько уровней вперед подгружать: столько потомков 2^L * k помещается в кэш-линию
+    static constexpr size_type prefetchStride() {
+        size_type stride = 1;
+        while (stride * 2 * sizeof(T) <= 64) {
+            stride *= 2;
+        }
+        return stride;
+    }
+
+    std::vector<T, Allocator> keys;  // keys[k - 1] - элемент с номером k
+    Compare comp;
+
+    template <typename It>
+    void fillSlots(std::vector<const T*>& slots, size_type k, It& it);
+
+    // Номера элементов с единицы; 0 - end()
+    template <typename K>
+    size_type lowerBound(const K& key) const;
+    template <typename K>
+    size_type upperBound(const K& key) const;
+    template <typename K>
+    size_type search(const K& key) const;
+    size_type first() const;
+    size_type last() const;
+    size_type successor(size_type k) const;
+    size_type predecessor(size_type k) const;
+
+    // Дружественный класс для итератора
+    friend class FrozenIterator<FrozenTree>;
+};
+
+// Включаем реализацию итератора после определения FrozenTree
+#include "../iterator/frozen_iterator.hpp"
+
+// Реализация методов FrozenTree
+
+template <typename T, typename Compare, typename Allocator>
+FrozenTree<T, Compare, Allocator>::FrozenTree(const Compare& comp, const Allocator& alloc)
+    : keys(alloc), comp(comp) {}
+
+template <typename T, typename Compare, typename Allocator>
+template <typename InputIt>
+FrozenTree<T, Compare, Allocator>::FrozenTree(InputIt first, size_type count, const Compare& comp, const Allocator& alloc)
+    : keys(alloc), comp(comp) {
+    // Обход номеров в симметричном порядке сопоставляет каждому номеру очередной ключ,
+    // после чего ключи копируются подряд в порядке номеров
+    std::vector<const T*> slots(count);
+    fillSlots(slots, 1, first);
+    keys.reserve(count);
+    for (const T* slot : slots) {
+        keys.push_back(*slot);
+    }
+}
+
+template <typename T, typename Compare, typename Allocator>
+template <typename It>
+void FrozenTree<T, Compare, Allocator>::fillSlots(std::vector<const T*>& slots, size_type k, It& it) {
+    if (k > slots.size()) {
+        return;
+    }
+    fillSlots(slots, 2 * k, it);
+    slots[k - 1] = &*it;
+    ++it;
+    fillSlots(slots, 2 * k + 1, it);
+}
+
+template <typename T, typename Compare, typename Allocator>
+template <typename K>
+typename FrozenTree<T, Compare, Allocator>::size_type FrozenTree<T, Compare, Allocator>::lowerBound(const K& key) const {
+    // Спуск до выхода за массив: направление выбирается арифметикой, а не переходом.
+    // Номер хранит путь в битах; последний поворот налево указывает на ответ.
+    const T* data = keys.data();
+    const size_type n = keys.size();
+    size_type k = 1;
+    while (k <= n) {
+        tree_detail::prefetch(data + (std::min(k * prefetchStride(), n) - 1));
+        k = 2 * k + static_cast<size_type>(comp(data[k - 1], key));
+    }
+    return k >> (frozen_detail::countTrailingZeros(~k) + 1);
+}
+
+template <typename T, typename Compare, typename Allocator>
+template <typename K>
+typename FrozenTree<T, Compare, Allocator>::size_type FrozenTree<T, Compare, Allocator>::upperBound(const K& key) const {
+    const T* data = keys.data();
+    const size_type n = keys.size();
+    size_type k = 1;
+    while (k <= n) {
+        tree_detail::prefetch(data + (std::min(k * prefetchStride(), n) - 1));
+        k = 2 * k + static_cast<size_type>(!comp(key, data[k - 1]));
+    }
+    return k >> (frozen_detail::countTrailingZeros(~k) + 1);
+}
+
+template <typename T, typename Compare, typename Allocator>
+template <typename K>
+typename FrozenTree<T, Compare, Allocator>::size_type FrozenTree<T, Compare, Allocator>::search(const K& key) const {
+    size_type k = lowerBound(key);
+    return k != 0 && !comp(key, keys[k - 1]) ? k : 0;
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename FrozenTree<T, Compare, Allocator>::size_type FrozenTree<T, Compare, Allocator>::first() const {
+    size_type k = keys.empty() ? 0 : 1;
+    while (k != 0 && 2 * k <= keys.size()) {
+        k = 2 * k;
+    }
+    return k;
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename FrozenTree<T, Compare, Allocator>::size_type FrozenTree<T, Compare, Allocator>::last() const {
+    size_type k = keys.empty() ? 0 : 1;
+    while (k != 0 && 2 * k + 1 <= keys.size()) {
+        k = 2 * k + 1;
+    }
+    return k;
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename FrozenTree<T, Compare, Allocator>::size_type FrozenTree<T, Compare, Allocator>::successor(size_type k) const {
+    // Есть правое поддерево - его минимум; иначе подъем, пока идем из правого ребенка
+    if (2 * k + 1 <= keys.size()) {
+        k = 2 * k + 1;
+        while (2 * k <= keys.size()) {
+            k = 2 * k;
+        }
+        return k;
+    }
+    return k >> (frozen_detail::countTrailingZeros(~k) + 1);
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename FrozenTree<T, Compare, Allocator>::size_type FrozenTree<T, Compare, Allocator>::predecessor(size_type k) const {
+    if (2 * k <= keys.size()) {
+        k = 2 * k;
+        while (2 * k + 1 <= keys.size()) {
+            k = 2 * k + 1;
+        }
+        return k;
+    }
+    return k >> (frozen_detail::countTrailingZeros(k) + 1);
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename FrozenTree<T, Compare, Allocator>::iterator FrozenTree<T, Compare, Allocator>::find(const T& value) const {
+    return iterator(search(value), this);
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename FrozenTree<T, Compare, Allocator>::iterator FrozenTree<T, Compare, Allocator>::lower_bound(const T& value) const {
+    return iterator(lowerBound(value), this);
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename FrozenTree<T, Compare, Allocator>::iterator FrozenTree<T, Compare, Allocator>::upper_bound(const T& value) const {
+    return iterator(upperBound(value), this);
+}
+
+template <typename T, typename Compare, typename Allocator>
+std::pair<typename FrozenTree<T, Compare, Allocator>::iterator, typename FrozenTree<T, Compare, Allocator>::iterator>
+FrozenTree<T, Compare, Allocator>::equal_range(const T& value) const {
+    return std::make_pair(lower_bound(value), upper_bound(value));
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename FrozenTree<T, Compare, Allocator>::size_type FrozenTree<T, Compare, Allocator>::count(const T& value) const {
+    return search(value) != 0 ? 1 : 0;
+}
+
+template <typename T, typename Compare, typename Allocator>
+bool FrozenTree<T, Compare, Allocator>::contains(const T& value) const {
+    return search(value) != 0;
+}
+
+template <typename T, typename Compare, typename Allocator>
+template <typename K, typename C, typename>
+typename FrozenTree<T, Compare, Allocator>::iterator FrozenTree<T, Compare, Allocator>::find(const K& key) const {
+    return iterator(search(key), this);
+}
+
+template <typename T, typename Compare, typename Allocator>
+template <typename K, typename C, typename>
+typename FrozenTree<T, Compare, Allocator>::iterator FrozenTree<T, Compare, Allocator>::lower_bound(const K& key) const {
+    return iterator(lowerBound(key), this);
+}
+
+template <typename T, typename Compare, typename Allocator>
+template <typename K, typename C, typename>
+typename FrozenTree<T, Compare, Allocator>::iterator FrozenTree<T, Compare, Allocator>::upper_bound(const K& key) const {
+    return iterator(upperBound(key), this);
+}
+
+template <typename T, typename Compare, typename Allocator>
+template <typename K, typename C, typename>
+std::pair<typename FrozenTree<T, Compare, Allocator>::iterator, typename FrozenTree<T, Compare, Allocator>::iterator>
+FrozenTree<T, Compare, Allocator>::equal_range(const K& key) const {
+    return std::make_pair(lower_bound(key), upper_bound(key));
+}
+
+template <typename T, typename Compare, typename Allocator>
+template <typename K, typename C, typename>
+typename FrozenTree<T, Compare, Allocator>::size_type FrozenTree<T, Compare, Allocator>::count(const K& key) const {
+    return search(key) != 0 ? 1 : 0;
+}
+
+template <typename T, typename Compare, typename Allocator>
+template <typename K, typename C, typename>
+bool FrozenTree<T, Compare, Allocator>::contains(const K& key) const {
+    return search(key) != 0;
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename FrozenTree<T, Compare, Allocator>::iterator FrozenTree<T, Compare, Allocator>::begin() const {
+    return iterator(first(), this);
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename FrozenTree<T, Compare, Allocator>::iterator FrozenTree<T, Compare, Allocator>::end() const {
+    return iterator(0, this);
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename FrozenTree<T, Compare, Allocator>::iterator FrozenTree<T, Compare, Allocator>::cbegin() const {
+    return begin();
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename FrozenTree<T, Compare, Allocator>::iterator FrozenTree<T, Compare, Allocator>::cend() const {
+    return end();
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename FrozenTree<T, Compare, Allocator>::size_type FrozenTree<T, Compare, Allocator>::size() const {
+    return keys.size();
+}
+
+template <typename T, typename Compare, typename Allocator>
+bool FrozenTree<T, Compare, Allocator>::empty() const {
+    return keys.empty();
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename FrozenTree<T, Compare, Allocator>::allocator_type FrozenTree<T, Compare, Allocator>::get_allocator() const {
+    return keys.get_allocator();
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename FrozenTree<T, Compare, Allocator>::key_compare FrozenTree<T, Compare, Allocator>::key_comp() const {
+    return comp;
+}
+
+#endif // FROZEN_TREE_HPP
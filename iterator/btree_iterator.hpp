@@ -0,0 +1,96 @@
+#ifndef BTREE_ITERATOR_HPP
+#define BTREE_ITERATOR_HPP
+
+#include <cstddef>
+#include <iterator>
+#include <stdexcept>
+
+// Итератор B-дерева: узел и индекс значения в нем
+// BTreeT - конкретная специализация BTree (определена в btree.hpp)
+template <typename BTreeT>
+class BTreeIterator {
+public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = typename BTreeT::value_type;
+    using difference_type = std::ptrdiff_t;
+    using pointer = value_type*;
+    using reference = value_type&;
+
+private:
+    using Node = typename BTreeT::Node;
+    using size_type = typename BTreeT::size_type;
+    Node* current;  // nullptr у end()
+    size_type position;
+    const BTreeT* tree;
+
+public:
+    BTreeIterator() : current(nullptr), position(0), tree(nullptr) {}
+    BTreeIterator(Node* node, size_type pos, const BTreeT* t) : current(node), position(pos), tree(t) {}
+    BTreeIterator(const BTreeIterator& other) : current(other.current), position(other.position), tree(other.tree) {}
+
+    BTreeIterator& operator=(const BTreeIterator& other) {
+        if (this != &other) {
+            current = other.current;
+            position = other.position;
+            tree = other.tree;
+        }
+        return *this;
+    }
+
+    reference operator*() const {
+        if (current == nullptr) {
+            throw std::runtime_error("Dereferencing end iterator");
+        }
+        return current->values()[position];
+    }
+
+    pointer operator->() const {
+        if (current == nullptr) {
+            throw std::runtime_error("Dereferencing end iterator");
+        }
+        return current->values() + position;
+    }
+
+    BTreeIterator& operator++() {
+        if (current == nullptr) {
+            return *this;
+        }
+        tree->increment(current, position);
+        return *this;
+    }
+
+    BTreeIterator operator++(int) {
+        BTreeIterator tmp = *this;
+        ++(*this);
+        return tmp;
+    }
+
+    BTreeIterator& operator--() {
+        if (current == nullptr) {
+            // Если итератор на end(), переходим к максимальному элементу
+            if (tree && tree->root != nullptr) {
+                current = tree->rightmost(tree->root);
+                position = current->count - 1;
+            }
+            return *this;
+        }
+        tree->decrement(current, position);
+        return *this;
+    }
+
+    BTreeIterator operator--(int) {
+        BTreeIterator tmp = *this;
+        --(*this);
+        return tmp;
+    }
+
+    bool operator==(const BTreeIterator& other) const {
+        return current == other.current && position == other.position;
+    }
+
+    bool operator!=(const BTreeIterator& other) const {
+        return !(*this == other);
+    }
+};
+
+#endif // BTREE_ITERATOR_HPP
@@ -0,0 +1,126 @@
+#ifndef COMPACT_ITERATOR_HPP
+#define COMPACT_ITERATOR_HPP
+
+#include <cstddef>
+#include <iterator>
+#include <stdexcept>
+#include <vector>
+
+// Итератор компактного дерева: у узлов нет ссылки на родителя, поэтому путь
+// от корня до текущего узла хранится в стеке номеров. Пустой путь - end().
+// Вставка и удаление делают итераторы недействительными (узлы переезжают в массиве).
+// CompactT - конкретная специализация CompactTree (определена в compact_tree.hpp)
+template <typename CompactT>
+class CompactIterator {
+public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = typename CompactT::value_type;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const value_type*;
+    using reference = const value_type&;
+
+private:
+    using Index = typename CompactT::Index;
+    std::vector<Index> path;
+    const CompactT* tree;
+
+    void pushLeft(Index node) {
+        while (node != CompactT::NO_NODE) {
+            path.push_back(node);
+            node = tree->nodes[node].left;
+        }
+    }
+
+    void pushRight(Index node) {
+        while (node != CompactT::NO_NODE) {
+            path.push_back(node);
+            node = tree->nodes[node].right();
+        }
+    }
+
+public:
+    CompactIterator() : tree(nullptr) {}
+    CompactIterator(std::vector<Index> p, const CompactT* t) : path(std::move(p)), tree(t) {}
+
+    // Итератор на минимальный элемент дерева
+    static CompactIterator leftmost(const CompactT* t) {
+        CompactIterator it({}, t);
+        it.pushLeft(t->root);
+        return it;
+    }
+
+    reference operator*() const {
+        if (path.empty()) {
+            throw std::runtime_error("Dereferencing end iterator");
+        }
+        return tree->nodes[path.back()].val;
+    }
+
+    pointer operator->() const {
+        return &**this;
+    }
+
+    CompactIterator& operator++() {
+        if (path.empty()) {
+            return *this;
+        }
+        Index node = path.back();
+        Index right = tree->nodes[node].right();
+        if (right != CompactT::NO_NODE) {
+            pushLeft(right);
+            return *this;
+        }
+        // Поднимаемся, пока приходим из правого поддерева
+        path.pop_back();
+        while (!path.empty() && tree->nodes[path.back()].right() == node) {
+            node = path.back();
+            path.pop_back();
+        }
+        return *this;
+    }
+
+    CompactIterator operator++(int) {
+        CompactIterator tmp = *this;
+        ++(*this);
+        return tmp;
+    }
+
+    CompactIterator& operator--() {
+        // С end() переходим к максимальному элементу
+        if (path.empty()) {
+            pushRight(tree->root);
+            return *this;
+        }
+        Index node = path.back();
+        Index left = tree->nodes[node].left;
+        if (left != CompactT::NO_NODE) {
+            pushRight(left);
+            return *this;
+        }
+        path.pop_back();
+        while (!path.empty() && tree->nodes[path.back()].left == node) {
+            node = path.back();
+            path.pop_back();
+        }
+        return *this;
+    }
+
+    CompactIterator operator--(int) {
+        CompactIterator tmp = *this;
+        --(*this);
+        return tmp;
+    }
+
+    bool operator==(const CompactIterator& other) const {
+        if (path.empty() || other.path.empty()) {
+            return path.empty() == other.path.empty();
+        }
+        return path.back() == other.path.back();
+    }
+
+    bool operator!=(const CompactIterator& other) const {
+        return !(*this == other);
+    }
+};
+
+#endif // COMPACT_ITERATOR_HPP
@@ -0,0 +1,74 @@
+#ifndef FROZEN_ITERATOR_HPP
+#define FROZEN_ITERATOR_HPP
+
+#include <cstddef>
+#include <iterator>
+#include <stdexcept>
+
+// Итератор снимка: номер элемента в раскладке Эйтцингера, 0 - end().
+// Снимок неизменяем, поэтому значения доступны только для чтения.
+// FrozenT - конкретная специализация FrozenTree (определена в frozen_tree.hpp)
+template <typename FrozenT>
+class FrozenIterator {
+public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = typename FrozenT::value_type;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const value_type*;
+    using reference = const value_type&;
+
+private:
+    using size_type = typename FrozenT::size_type;
+    size_type index;
+    const FrozenT* tree;
+
+public:
+    FrozenIterator() : index(0), tree(nullptr) {}
+    FrozenIterator(size_type k, const FrozenT* t) : index(k), tree(t) {}
+
+    reference operator*() const {
+        if (index == 0) {
+            throw std::runtime_error("Dereferencing end iterator");
+        }
+        return tree->keys[index - 1];
+    }
+
+    pointer operator->() const {
+        return &**this;
+    }
+
+    FrozenIterator& operator++() {
+        if (index != 0) {
+            index = tree->successor(index);
+        }
+        return *this;
+    }
+
+    FrozenIterator operator++(int) {
+        FrozenIterator tmp = *this;
+        ++(*this);
+        return tmp;
+    }
+
+    FrozenIterator& operator--() {
+        // С end() переходим к максимальному элементу
+        index = index == 0 ? tree->last() : tree->predecessor(index);
+        return *this;
+    }
+
+    FrozenIterator operator--(int) {
+        FrozenIterator tmp = *this;
+        --(*this);
+        return tmp;
+    }
+
+    bool operator==(const FrozenIterator& other) const {
+        return index == other.index;
+    }
+
+    bool operator!=(const FrozenIterator& other) const {
+        return !(*this == other);
+    }
+};
+
+#endif // FROZEN_ITERATOR_HPP
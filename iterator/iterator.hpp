@@ -4,29 +4,26 @@
 #include <iterator>
 #include <stdexcept>
 
-// Предварительное объявление Tree (Tree уже определен в tree.hpp)
-template <typename T>
-class Tree;
-
 // Реализация итератора
-template <typename T>
+// TreeT - конкретная специализация Tree (определена в tree.hpp)
+template <typename TreeT>
 class TreeIterator {
 public:
     using iterator_category = std::bidirectional_iterator_tag;
-    using value_type = T;
+    using value_type = typename TreeT::value_type;
     using difference_type = std::ptrdiff_t;
-    using pointer = T*;
-    using reference = T&;
+    using pointer = value_type*;
+    using reference = value_type&;
 
 private:
-    using Node = typename Tree<T>::Node;
+    using Node = typename TreeT::Node;
     Node* current;
     Node* nil;
-    const Tree<T>* tree;
+    const TreeT* tree;
 
 public:
     TreeIterator() : current(nullptr), nil(nullptr), tree(nullptr) {}
-    TreeIterator(Node* node, Node* nilNode, const Tree<T>* t) : current(node), nil(nilNode), tree(t) {}
+    TreeIterator(Node* node, Node* nilNode, const TreeT* t) : current(node), nil(nilNode), tree(t) {}
     TreeIterator(const TreeIterator& other) : current(other.current), nil(other.nil), tree(other.tree) {}
 
     TreeIterator& operator=(const TreeIterator& other) {
@@ -56,7 +53,7 @@ public:
         if (current == nil || current == nullptr) {
             return *this;
         }
-        current = tree->successor(current);
+        current = tree->nextNode(current);
         return *this;
     }
 
@@ -69,12 +66,12 @@ public:
     TreeIterator& operator--() {
         if (current == nil || current == nullptr) {
             // Если итератор на end(), переходим к максимальному элементу
-            if (tree && tree->root != tree->nil) {
-                current = tree->maximum(tree->root);
+            if (tree) {
+                current = tree->rightmost;
             }
             return *this;
         }
-        current = tree->predecessor(current);
+        current = tree->prevNode(current);
         return *this;
     }
 
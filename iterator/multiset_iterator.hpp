@@ -0,0 +1,79 @@
+#ifndef MULTISET_ITERATOR_HPP
+#define MULTISET_ITERATOR_HPP
+
+#include <cstddef>
+#include <iterator>
+
+// Итератор мультимножества со счетчиками: каждый элемент словаря (значение, счетчик)
+// выдается столько раз, сколько он встречается. Позиция - элемент словаря и номер
+// повторения; end() - конец словаря с номером 0.
+// MapIt - итератор TreeMap<T, size_type>
+template <typename MapIt>
+class MultisetIterator {
+public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = typename std::iterator_traits<MapIt>::value_type::first_type;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const value_type*;
+    using reference = const value_type&;
+
+private:
+    MapIt entry;
+    std::size_t occurrence;
+
+public:
+    MultisetIterator() : occurrence(0) {}
+    MultisetIterator(MapIt it, std::size_t k) : entry(it), occurrence(k) {}
+
+    reference operator*() const {
+        return entry->first;
+    }
+
+    pointer operator->() const {
+        return &**this;
+    }
+
+    // Сколько раз встречается текущее значение
+    std::size_t multiplicity() const {
+        return entry->second;
+    }
+
+    MultisetIterator& operator++() {
+        if (++occurrence == entry->second) {
+            ++entry;
+            occurrence = 0;
+        }
+        return *this;
+    }
+
+    MultisetIterator operator++(int) {
+        MultisetIterator tmp = *this;
+        ++(*this);
+        return tmp;
+    }
+
+    MultisetIterator& operator--() {
+        if (occurrence == 0) {
+            --entry;
+            occurrence = entry->second;
+        }
+        --occurrence;
+        return *this;
+    }
+
+    MultisetIterator operator--(int) {
+        MultisetIterator tmp = *this;
+        --(*this);
+        return tmp;
+    }
+
+    bool operator==(const MultisetIterator& other) const {
+        return entry == other.entry && occurrence == other.occurrence;
+    }
+
+    bool operator!=(const MultisetIterator& other) const {
+        return !(*this == other);
+    }
+};
+
+#endif // MULTISET_ITERATOR_HPP
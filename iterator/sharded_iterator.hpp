@@ -0,0 +1,81 @@
+#ifndef SHARDED_ITERATOR_HPP
+#define SHARDED_ITERATOR_HPP
+
+#include <cstddef>
+#include <iterator>
+#include <stdexcept>
+
+// Итератор сегментированного дерева: номер сегмента и итератор внутри него.
+// Пустые сегменты пропускаются; номер, равный числу сегментов, - end().
+// ShardedT - конкретная специализация ShardedTree (определена в sharded_tree.hpp)
+template <typename ShardedT>
+class ShardedIterator {
+public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = typename ShardedT::value_type;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const value_type*;
+    using reference = const value_type&;
+
+private:
+    using size_type = typename ShardedT::size_type;
+    using ShardIterator = typename ShardedT::ShardTree::iterator;
+    const ShardedT* tree;
+    size_type shard;
+    ShardIterator inner;  // не используется у end()
+
+public:
+    ShardedIterator() : tree(nullptr), shard(0), inner() {}
+    ShardedIterator(const ShardedT* t, size_type s, ShardIterator it) : tree(t), shard(s), inner(it) {}
+
+    reference operator*() const {
+        if (tree == nullptr || shard == tree->shards.size()) {
+            throw std::runtime_error("Dereferencing end iterator");
+        }
+        return *inner;
+    }
+
+    pointer operator->() const {
+        return &**this;
+    }
+
+    ShardedIterator& operator++() {
+        if (tree != nullptr && shard != tree->shards.size()) {
+            ++inner;
+            tree->skipForward(shard, inner);
+        }
+        return *this;
+    }
+
+    ShardedIterator operator++(int) {
+        ShardedIterator tmp = *this;
+        ++(*this);
+        return tmp;
+    }
+
+    ShardedIterator& operator--() {
+        if (tree != nullptr) {
+            tree->skipBackward(shard, inner);
+        }
+        return *this;
+    }
+
+    ShardedIterator operator--(int) {
+        ShardedIterator tmp = *this;
+        --(*this);
+        return tmp;
+    }
+
+    bool operator==(const ShardedIterator& other) const {
+        if (shard != other.shard) {
+            return false;
+        }
+        return tree == nullptr || shard == tree->shards.size() || inner == other.inner;
+    }
+
+    bool operator!=(const ShardedIterator& other) const {
+        return !(*this == other);
+    }
+};
+
+#endif // SHARDED_ITERATOR_HPP
@@ -0,0 +1,81 @@
+#ifndef STACK_ITERATOR_HPP
+#define STACK_ITERATOR_HPP
+
+#include <cstddef>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// Итератор по неизменяемым узлам без ссылок на родителя: путь от корня хранится в стеке.
+// Вершина стека - текущий узел, ниже - предки, к которым еще предстоит вернуться.
+// Пустой стек - end(). Node: val, left, right
+template <typename Node, typename T>
+class StackIterator {
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const value_type*;
+    using reference = const value_type&;
+
+private:
+    std::vector<const Node*> path;
+
+    void pushLeft(const Node* node) {
+        while (node != nullptr) {
+            path.push_back(node);
+            node = node->left;
+        }
+    }
+
+public:
+    StackIterator() = default;
+    explicit StackIterator(std::vector<const Node*> p) : path(std::move(p)) {}
+
+    // Итератор на минимальный элемент поддерева
+    static StackIterator leftmost(const Node* root) {
+        StackIterator it;
+        it.pushLeft(root);
+        return it;
+    }
+
+    reference operator*() const {
+        if (path.empty()) {
+            throw std::runtime_error("Dereferencing end iterator");
+        }
+        return path.back()->val;
+    }
+
+    pointer operator->() const {
+        return &**this;
+    }
+
+    StackIterator& operator++() {
+        if (!path.empty()) {
+            const Node* node = path.back();
+            path.pop_back();
+            pushLeft(node->right);
+        }
+        return *this;
+    }
+
+    StackIterator operator++(int) {
+        StackIterator tmp = *this;
+        ++(*this);
+        return tmp;
+    }
+
+    bool operator==(const StackIterator& other) const {
+        if (path.empty() || other.path.empty()) {
+            return path.empty() == other.path.empty();
+        }
+        return path.back() == other.path.back();
+    }
+
+    bool operator!=(const StackIterator& other) const {
+        return !(*this == other);
+    }
+};
+
+#endif // STACK_ITERATOR_HPP
@@ -2,7 +2,23 @@
 #include <algorithm>
 #include <vector>
 #include <fstream>
+#include <string>
+#include <string_view>
+#include <functional>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <cstdio>
 #include "tree/tree.hpp"
+#include "btree/btree.hpp"
+#include "compact/compact_tree.hpp"
+#include "concurrent/concurrent_tree.hpp"
+#include "sharded/sharded_tree.hpp"
+#include "persistent/persistent_tree.hpp"
+#include "map/tree_map.hpp"
+#include "multiset/tree_multiset.hpp"
 #include "constructor_utils/constructor_utils.hpp"
 
 void testBasicOperations() {
@@ -104,13 +120,20 @@ void testSTLAlgorithms() {
     });
     std::cout << std::endl;
     
-    // std::lower_bound (требует random_access, но попробуем)
-    // Для bidirectional итератора используем ручной поиск
+    // Границы ищутся методами дерева за O(log n):
+    // std::lower_bound на bidirectional итераторе проходит элементы линейно
     int target = 5;
-    auto lower = std::lower_bound(tree.begin(), tree.end(), target);
+    auto lower = tree.lower_bound(target);
     if (lower != tree.end()) {
-        std::cout << "std::lower_bound for " << target << ": " << *lower << std::endl;
+        std::cout << "lower_bound for " << target << ": " << *lower << std::endl;
     }
+    auto upper = tree.upper_bound(target);
+    if (upper != tree.end()) {
+        std::cout << "upper_bound for " << target << ": " << *upper << std::endl;
+    }
+    auto range = tree.equal_range(target);
+    std::cout << "equal_range for " << target << ": " << std::distance(range.first, range.second) << " element(s)" << std::endl;
+    std::cout << "count(5)=" << tree.count(5) << ", contains(10)=" << tree.contains(10) << std::endl;
     
     std::cout << std::endl;
 }
@@ -144,6 +167,870 @@ void testConstructors() {
     std::cout << std::endl;
 }
 
+// Ключ без конструктора по умолчанию, считающий копирования
+struct HeavyKey {
+    static size_t copies;
+    std::string name;
+    
+    explicit HeavyKey(std::string n) : name(std::move(n)) {}
+    HeavyKey(const HeavyKey& other) : name(other.name) { ++copies; }
+    HeavyKey(HeavyKey&&) = default;
+    
+    bool operator<(const HeavyKey& other) const { return name < other.name; }
+};
+size_t HeavyKey::copies = 0;
+
+void testEmplace() {
+    std::cout << "=== Emplace Test ===" << std::endl;
+    
+    Tree<HeavyKey> tree;
+    tree.emplace("delta");
+    tree.emplace(std::string("alpha"));
+    tree.insert(HeavyKey("charlie"));
+    auto result = tree.emplace("alpha");
+    std::cout << "Emplace duplicate: success=" << result.second << std::endl;
+    
+    std::cout << "Elements: ";
+    for (auto it = tree.begin(); it != tree.end(); ++it) {
+        std::cout << it->name << " ";
+    }
+    std::cout << std::endl;
+    std::cout << "Key copies: " << HeavyKey::copies << std::endl;
+    
+    std::cout << std::endl;
+}
+
+void testCustomComparator() {
+    std::cout << "=== Custom Comparator Test ===" << std::endl;
+    
+    Tree<int, std::greater<int>> descending;
+    for (int val : {5, 3, 7, 2, 4, 6, 8}) {
+        descending.insert(val);
+    }
+    std::cout << "Descending order: ";
+    for (auto it = descending.begin(); it != descending.end(); ++it) {
+        std::cout << *it << " ";
+    }
+    std::cout << std::endl;
+    
+    // Прозрачный компаратор: поиск по string_view без временной строки
+    Tree<std::string, std::less<>> names;
+    names.insert("alice");
+    names.insert("bob");
+    names.insert("carol");
+    std::string_view key = "bob";
+    std::cout << "Transparent find(\"bob\"): " << (names.find(key) != names.end() ? "found" : "not found") << std::endl;
+    std::cout << "Transparent lower_bound(\"b\"): " << *names.lower_bound(std::string_view("b")) << std::endl;
+    std::cout << "Transparent erase(\"carol\"): erased=" << names.erase(std::string_view("carol")) << ", size=" << names.size() << std::endl;
+    
+    std::cout << std::endl;
+}
+
+void testOrderStatistics() {
+    std::cout << "=== Order Statistics Test ===" << std::endl;
+    
+    OrderStatisticTree<int> tree;
+    for (int val = 10; val <= 100; val += 10) {
+        tree.insert(val);
+    }
+    tree.erase(50);
+    
+    std::cout << "nth(0)=" << *tree.nth(0) << ", nth(4)=" << *tree.nth(4) << ", nth(8)=" << *tree.nth(8) << std::endl;
+    std::cout << "rank(60)=" << tree.rank(60) << ", rank(55)=" << tree.rank(55) << std::endl;
+    std::cout << "count_range(20, 70)=" << tree.count_range(20, 70) << std::endl;
+    std::cout << "distance(begin, find(90))=" << tree.distance(tree.begin(), tree.find(90)) << std::endl;
+    
+    // Медиана (50-й перцентиль)
+    std::cout << "Median: " << *tree.nth(tree.size() / 2) << std::endl;
+    
+    std::cout << std::endl;
+}
+
+// Объект хранилища: идентификатор и размер в байтах
+struct StoredObject {
+    int id;
+    size_t bytes;
+    
+    bool operator<(const StoredObject& other) const { return id < other.id; }
+};
+
+// Моноид суммы байтов по поддереву
+struct TotalBytes {
+    using value_type = size_t;
+    static size_t identity() { return 0; }
+    static size_t lift(const StoredObject& obj) { return obj.bytes; }
+    static size_t combine(size_t a, size_t b) { return a + b; }
+};
+
+void testRangeAggregate() {
+    std::cout << "=== Range Aggregate Test ===" << std::endl;
+    
+    Tree<StoredObject, std::less<StoredObject>, std::allocator<StoredObject>, MonoidAugment<TotalBytes>> objects;
+    for (int id = 1; id <= 10; ++id) {
+        objects.insert(StoredObject{id, static_cast<size_t>(id) * 100});
+    }
+    objects.erase(StoredObject{5, 0});
+    
+    std::cout << "Total bytes for ids [3, 7]: " << objects.aggregate(StoredObject{3, 0}, StoredObject{7, 0}) << std::endl;
+    std::cout << "Total bytes for ids [1, 10]: " << objects.aggregate(StoredObject{1, 0}, StoredObject{10, 0}) << std::endl;
+    std::cout << "Total bytes for ids [11, 20]: " << objects.aggregate(StoredObject{11, 0}, StoredObject{20, 0}) << std::endl;
+    
+    std::cout << std::endl;
+}
+
+void testBulkConstruction() {
+    std::cout << "=== Bulk Construction Test ===" << std::endl;
+    
+    std::vector<int> sorted;
+    for (int i = 1; i <= 1000; ++i) {
+        sorted.push_back(i);
+    }
+    Tree<int> tree(sorted.begin(), sorted.end());
+    std::cout << "From sorted range: size=" << tree.size() << ", first=" << *tree.begin() << ", last=" << *(--tree.end()) << std::endl;
+    
+    std::vector<int> unsorted = {9, 4, 7, 1, 4, 8, 2, 9};
+    tree.assign_sorted(unsorted.begin(), unsorted.end());
+    std::cout << "From unsorted range with duplicates: ";
+    for (auto it = tree.begin(); it != tree.end(); ++it) {
+        std::cout << *it << " ";
+    }
+    std::cout << "(size=" << tree.size() << ")" << std::endl;
+    
+    std::cout << std::endl;
+}
+
+template <typename TreeType>
+void printTree(const char* label, const TreeType& tree) {
+    std::cout << label << ": ";
+    for (auto it = tree.begin(); it != tree.end(); ++it) {
+        std::cout << *it << " ";
+    }
+    std::cout << "(size=" << tree.size() << ")" << std::endl;
+}
+
+void testSplitJoin() {
+    std::cout << "=== Split/Join Test ===" << std::endl;
+    
+    std::vector<int> values = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+    Tree<int> tree(values.begin(), values.end());
+    
+    Tree<int> upper = tree.split(6);
+    printTree("Lower part (< 6)", tree);
+    printTree("Upper part (>= 6)", upper);
+    
+    tree.join(upper);
+    printTree("Joined back", tree);
+    
+    // size() после split - простое чтение: части можно читать из нескольких потоков
+    Tree<int> big;
+    for (int i = 0; i < 100000; ++i) {
+        big.insert(i);
+    }
+    const Tree<int> bigUpper = big.split(30000);
+    std::atomic<size_t> sizeSum{0};
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 2; ++r) {
+        readers.emplace_back([&] {
+            sizeSum += bigUpper.size() + big.size();
+        });
+    }
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    std::cout << "Split sizes: " << big.size() << " + " << bigUpper.size() << ", concurrent reads sum=" << sizeSum << std::endl;
+    
+    Tree<int> evens;
+    Tree<int> small;
+    for (int i = 0; i <= 12; i += 2) {
+        evens.insert(i);
+    }
+    for (int i = 0; i <= 5; ++i) {
+        small.insert(i);
+    }
+    
+    Tree<int> unionTree(evens);
+    unionTree.union_with(small);
+    printTree("Union", unionTree);
+    
+    Tree<int> intersection(evens);
+    intersection.intersect_with(small);
+    printTree("Intersection", intersection);
+    
+    Tree<int> difference(evens);
+    difference.difference_with(small);
+    printTree("Difference", difference);
+    
+    std::cout << std::endl;
+}
+
+void testBatchOperations() {
+    std::cout << "=== Hint and Batch Test ===" << std::endl;
+    
+    // Воспроизведение отсортированного журнала: подсказка - позиция предыдущей вставки
+    Tree<int> log;
+    auto hint = log.end();
+    for (int i = 1; i <= 10; ++i) {
+        hint = log.insert(hint, i * 10);
+    }
+    hint = log.insert(log.find(50), 45);
+    std::cout << "Inserted with hint: " << *hint << std::endl;
+    printTree("After hinted inserts", log);
+    
+    std::vector<int> batch = {95, 5, 35, 5, 200, 10};
+    log.insert_range(batch.begin(), batch.end());
+    printTree("After insert_range", log);
+    
+    std::vector<int> removal = {5, 100, 10, 999, 45};
+    log.erase_range(removal.begin(), removal.end());
+    printTree("After erase_range", log);
+    
+    std::cout << std::endl;
+}
+
+void testThreadedTree() {
+    std::cout << "=== Threaded Tree Test ===" << std::endl;
+    
+    ThreadedTree<int> tree;
+    for (int val : {40, 20, 60, 10, 30, 50, 70}) {
+        tree.insert(val);
+    }
+    tree.erase(40);
+    tree.erase(10);
+    
+    printTree("Forward", tree);
+    std::cout << "Backward: ";
+    for (auto it = tree.end(); it != tree.begin();) {
+        --it;
+        std::cout << *it << " ";
+    }
+    std::cout << std::endl;
+    std::cout << "First: " << *tree.begin() << ", last: " << *(--tree.end()) << std::endl;
+    
+    ThreadedTree<int> upper = tree.split(50);
+    printTree("Split lower", tree);
+    printTree("Split upper", upper);
+    
+    std::cout << std::endl;
+}
+
+void testBTree() {
+    std::cout << "=== BTree Test ===" << std::endl;
+    
+    // Тот же интерфейс, что у Tree: достаточно сменить тип
+    BTree<int> btree;
+    Tree<int> reference;
+    for (int i = 0; i < 1000; ++i) {
+        int value = (i * 7919) % 1009;
+        btree.insert(value);
+        reference.insert(value);
+    }
+    for (int i = 0; i < 1000; i += 3) {
+        btree.erase(i);
+        reference.erase(i);
+    }
+    std::cout << "Node capacity: " << BTree<int>::node_capacity() << std::endl;
+    std::cout << "Size: " << btree.size() << ", matches Tree: "
+              << std::equal(btree.begin(), btree.end(), reference.begin(), reference.end()) << std::endl;
+    
+    auto it = btree.find(500);
+    std::cout << "find(500): " << (it != btree.end() ? "found" : "not found") << std::endl;
+    std::cout << "lower_bound(999): " << *btree.lower_bound(999) << std::endl;
+    std::cout << "Last element: " << *(--btree.end()) << std::endl;
+    
+    BTree<std::string, std::less<>> names;
+    names.emplace("alice");
+    names.emplace(3, 'b');
+    std::cout << "Transparent find(\"bbb\"): "
+              << (names.find(std::string_view("bbb")) != names.end() ? "found" : "not found") << std::endl;
+    
+    std::cout << std::endl;
+}
+
+void testFrozenTree() {
+    std::cout << "=== Frozen Tree Test ===" << std::endl;
+    
+    Tree<int> tree;
+    for (int val : {50, 30, 70, 20, 40, 60, 80, 10}) {
+        tree.insert(val);
+    }
+    
+    // Снимок не зависит от исходного дерева
+    auto frozen = tree.freeze();
+    tree.clear();
+    
+    std::cout << "Frozen elements: ";
+    for (auto it = frozen.begin(); it != frozen.end(); ++it) {
+        std::cout << *it << " ";
+    }
+    std::cout << "(size=" << frozen.size() << ")" << std::endl;
+    std::cout << "lower_bound(45): " << *frozen.lower_bound(45) << std::endl;
+    std::cout << "upper_bound(50): " << *frozen.upper_bound(50) << std::endl;
+    std::cout << "contains(60): " << frozen.contains(60) << ", contains(65): " << frozen.contains(65) << std::endl;
+    std::cout << "lower_bound(90) is end: " << (frozen.lower_bound(90) == frozen.end()) << std::endl;
+    
+    std::cout << std::endl;
+}
+
+void benchmarkFindMany() {
+    std::cout << "=== Batched Lookup Benchmark ===" << std::endl;
+    
+    const size_t count = 500000;
+    std::mt19937 rng(42);
+    std::vector<int> values(count);
+    for (auto& value : values) {
+        value = static_cast<int>(rng());
+    }
+    Tree<int> tree(values.begin(), values.end());
+    
+    std::vector<int> keys(count);
+    for (size_t i = 0; i < count; ++i) {
+        keys[i] = (i % 2 == 0) ? values[rng() % count] : static_cast<int>(rng());
+    }
+    
+    auto start = std::chrono::steady_clock::now();
+    size_t foundLoop = 0;
+    for (int key : keys) {
+        foundLoop += tree.find(key) != tree.end();
+    }
+    auto middle = std::chrono::steady_clock::now();
+    std::vector<Tree<int>::iterator> results;
+    results.reserve(count);
+    tree.find_many(keys.begin(), keys.end(), std::back_inserter(results));
+    auto finish = std::chrono::steady_clock::now();
+    
+    size_t foundBatch = 0;
+    for (const auto& it : results) {
+        foundBatch += it != tree.end();
+    }
+    double loopSeconds = std::chrono::duration<double>(middle - start).count();
+    double batchSeconds = std::chrono::duration<double>(finish - middle).count();
+    std::cout << "Lookups: " << count << ", found (loop/batch): " << foundLoop << "/" << foundBatch << std::endl;
+    std::cout << "find loop:  " << count / loopSeconds / 1e6 << " M lookups/s" << std::endl;
+    std::cout << "find_many:  " << count / batchSeconds / 1e6 << " M lookups/s" << std::endl;
+    
+    std::cout << std::endl;
+}
+
+void testCompactTree() {
+    std::cout << "=== Compact Tree ===" << std::endl;
+    
+    CompactTree<int> small;
+    for (int value : {50, 30, 70, 20, 40, 60, 80, 30}) {
+        small.insert(value);
+    }
+    small.erase(40);
+    printTree("Compact tree", small);
+    std::cout << "lower_bound(45): " << *small.lower_bound(45) << ", contains(40): " << small.contains(40)
+              << ", max: " << *std::prev(small.end()) << std::endl;
+    
+    // Память и скорость поиска для мелких ключей в сравнении с Tree
+    const size_t count = 1000000;
+    std::mt19937 rng(7);
+    std::vector<int> values(count);
+    for (auto& value : values) {
+        value = static_cast<int>(rng());
+    }
+    Tree<int> tree(values.begin(), values.end());
+    CompactTree<int> compact(values.begin(), values.end());
+    std::cout << "Compact bytes per element: " << static_cast<double>(compact.memory_usage()) / compact.size() << std::endl;
+    
+    std::vector<int> keys(count);
+    for (size_t i = 0; i < count; ++i) {
+        keys[i] = (i % 2 == 0) ? values[rng() % count] : static_cast<int>(rng());
+    }
+    auto start = std::chrono::steady_clock::now();
+    size_t foundTree = 0;
+    for (int key : keys) {
+        foundTree += tree.contains(key);
+    }
+    auto middle = std::chrono::steady_clock::now();
+    size_t foundCompact = 0;
+    for (int key : keys) {
+        foundCompact += compact.contains(key);
+    }
+    auto finish = std::chrono::steady_clock::now();
+    std::cout << "Lookups: " << count << ", found (Tree/CompactTree): " << foundTree << "/" << foundCompact << std::endl;
+    std::cout << "Tree:        " << count / std::chrono::duration<double>(middle - start).count() / 1e6 << " M lookups/s" << std::endl;
+    std::cout << "CompactTree: " << count / std::chrono::duration<double>(finish - middle).count() / 1e6 << " M lookups/s" << std::endl;
+    
+    std::cout << std::endl;
+}
+
+void benchmarkCopyDestroy() {
+    std::cout << "=== Copy/Destroy Benchmark ===" << std::endl;
+    
+    const size_t count = 1000000;
+    std::mt19937 rng(11);
+    std::vector<std::string> values(count);
+    for (auto& value : values) {
+        value = "key-" + std::to_string(rng());
+    }
+    Tree<std::string> tree(values.begin(), values.end());
+    
+    auto ms = [](auto from, auto to) { return std::chrono::duration<double, std::milli>(to - from).count(); };
+    auto start = std::chrono::steady_clock::now();
+    Tree<std::string> copy(tree);
+    auto copied = std::chrono::steady_clock::now();
+    copy.clear();
+    auto cleared = std::chrono::steady_clock::now();
+    Tree<std::string> other(tree);
+    auto copiedAgain = std::chrono::steady_clock::now();
+    other.clear_async();
+    auto detached = std::chrono::steady_clock::now();
+    
+    std::cout << "Nodes: " << tree.size() << ", copy: " << ms(start, copied) << " ms, clear: " << ms(copied, cleared)
+              << " ms, clear_async (caller): " << ms(copiedAgain, detached) << " ms" << std::endl;
+    std::cout << "Copy equal: " << std::equal(tree.begin(), tree.end(), Tree<std::string>(tree).begin()) << std::endl;
+    
+    std::cout << std::endl;
+}
+
+void testNodeHandles() {
+    std::cout << "=== Node Handles ===" << std::endl;
+    
+    std::vector<int> hotValues = {1, 3, 5, 7, 9};
+    std::vector<int> coldValues = {2, 4, 5, 6};
+    Tree<int> hot(hotValues.begin(), hotValues.end());
+    Tree<int> cold(coldValues.begin(), coldValues.end());
+    
+    // Перенос одного узла: без выделения памяти и копирования значения
+    Tree<int>::node_type node = hot.extract(3);
+    std::cout << "Extracted: " << node.value() << std::endl;
+    auto result = cold.insert(std::move(node));
+    std::cout << "Inserted: " << result.inserted << ", at " << *result.position << std::endl;
+    
+    // Узел с ключом, который уже есть, возвращается в дескрипторе
+    auto duplicate = cold.insert(hot.extract(5));
+    std::cout << "Duplicate inserted: " << duplicate.inserted << ", handle keeps " << duplicate.node.value() << std::endl;
+    hot.insert(std::move(duplicate.node));
+    
+    hot.merge(cold);
+    printTree("Hot after merge", hot);
+    printTree("Cold after merge", cold);
+    
+    std::cout << std::endl;
+}
+
+void testConcurrentTree() {
+    std::cout << "=== Concurrent Tree ===" << std::endl;
+    
+    ConcurrentTree<int> tree = {50, 30, 70, 20, 40, 60, 80};
+    tree.insert(35);
+    tree.erase(70);
+    std::cout << "Size: " << tree.size() << ", contains 35: " << tree.contains(35)
+              << ", contains 70: " << tree.contains(70) << std::endl;
+    std::cout << "lower_bound(65): " << tree.lower_bound(65).value_or(-1) << std::endl;
+    
+    // Снимок не меняется после последующих записей
+    auto snapshot = tree.snapshot();
+    tree.insert(10);
+    tree.erase(50);
+    std::cout << "Snapshot: ";
+    for (int value : snapshot) {
+        std::cout << value << " ";
+    }
+    std::cout << std::endl;
+    std::cout << "Current: ";
+    auto current = tree.snapshot();
+    for (int value : current) {
+        std::cout << value << " ";
+    }
+    std::cout << std::endl;
+    
+    std::cout << std::endl;
+}
+
+// Читатели ищут постоянные (четные) ключи, писатель вставляет и удаляет нечетные.
+// Возвращает число поисков в секунду и число промахов по постоянным ключам
+template <typename Lookup, typename Update>
+std::pair<double, size_t> runReadersWriter(size_t readers, size_t lookups, size_t updates,
+                                           Lookup lookup, Update update) {
+    std::atomic<size_t> misses{0};
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (size_t r = 0; r < readers; ++r) {
+        threads.emplace_back([&, r] {
+            std::mt19937 rng(static_cast<unsigned>(r));
+            size_t missed = 0;
+            for (size_t i = 0; i < lookups; ++i) {
+                missed += !lookup(static_cast<int>(rng() % 100000) * 2);
+            }
+            misses += missed;
+        });
+    }
+    std::thread writer([&] {
+        std::mt19937 rng(12345);
+        for (size_t i = 0; i < updates; ++i) {
+            update(static_cast<int>(rng() % 100000) * 2 + 1, i % 2 == 0);
+        }
+    });
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    auto finish = std::chrono::steady_clock::now();
+    writer.join();
+    double seconds = std::chrono::duration<double>(finish - start).count();
+    return {readers * lookups / seconds, misses.load()};
+}
+
+void benchmarkConcurrentTree() {
+    std::cout << "=== Concurrent Readers Benchmark ===" << std::endl;
+    
+    const size_t readers = 4;
+    const size_t lookups = 200000;
+    const size_t updates = 50000;
+    std::vector<int> evens(100000);
+    for (size_t i = 0; i < evens.size(); ++i) {
+        evens[i] = static_cast<int>(i) * 2;
+    }
+    
+    // Базовый вариант: обычное дерево под общим мьютексом
+    Tree<int> locked(evens.begin(), evens.end());
+    std::mutex mutex;
+    auto lockedResult = runReadersWriter(readers, lookups, updates,
+        [&](int key) {
+            std::lock_guard<std::mutex> lock(mutex);
+            return locked.find(key) != locked.end();
+        },
+        [&](int key, bool add) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (add) {
+                locked.insert(key);
+            } else {
+                locked.erase(key);
+            }
+        });
+    
+    ConcurrentTree<int> concurrent(evens.begin(), evens.end());
+    auto concurrentResult = runReadersWriter(readers, lookups, updates,
+        [&](int key) {
+            return concurrent.contains(key);
+        },
+        [&](int key, bool add) {
+            if (add) {
+                concurrent.insert(key);
+            } else {
+                concurrent.erase(key);
+            }
+        });
+    
+    std::cout << "Readers: " << readers << ", lookups per reader: " << lookups
+              << ", concurrent updates: " << updates << std::endl;
+    std::cout << "Tree + mutex:   " << lockedResult.first / 1e6 << " M lookups/s, misses: "
+              << lockedResult.second << std::endl;
+    std::cout << "ConcurrentTree: " << concurrentResult.first / 1e6 << " M lookups/s, misses: "
+              << concurrentResult.second << std::endl;
+    
+    std::cout << std::endl;
+}
+
+void testShardedTree() {
+    std::cout << "=== Sharded Tree ===" << std::endl;
+    
+    ShardedTree<int> tree(std::vector<int>{10, 20, 30});
+    for (int value : {25, 5, 35, 15, 12, 31, 8}) {
+        tree.insert(value);
+    }
+    tree.erase(12);
+    std::cout << "Shards: " << tree.shard_count() << ", size: " << tree.size() << std::endl;
+    printTree("Ordered", tree);
+    std::cout << "lower_bound(16): " << *tree.lower_bound(16) << ", upper_bound(25): " << *tree.upper_bound(25) << std::endl;
+    std::cout << "Range [8, 31): ";
+    tree.for_each(8, 31, [](int value) { std::cout << value << " "; });
+    std::cout << std::endl;
+    
+    // Автоматическое деление разросшихся сегментов
+    ShardedTree<int> growing;
+    growing.set_max_shard_size(1000);
+    for (int i = 0; i < 10000; ++i) {
+        growing.insert(i);
+    }
+    std::cout << "After 10000 inserts with limit 1000: " << growing.shard_count() << " shards, sorted: "
+              << std::is_sorted(growing.begin(), growing.end()) << std::endl;
+    
+    std::cout << std::endl;
+}
+
+void benchmarkShardedInsert() {
+    std::cout << "=== Sharded Insert Benchmark ===" << std::endl;
+    
+    const size_t writers = 4;
+    const size_t perWriter = 100000;
+    auto run = [&](auto insert) {
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for (size_t w = 0; w < writers; ++w) {
+            threads.emplace_back([&, w] {
+                std::mt19937 rng(static_cast<unsigned>(w));
+                for (size_t i = 0; i < perWriter; ++i) {
+                    insert(static_cast<int>(rng()));
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return writers * perWriter / seconds;
+    };
+    
+    Tree<int> locked;
+    std::mutex mutex;
+    double lockedRate = run([&](int key) {
+        std::lock_guard<std::mutex> lock(mutex);
+        locked.insert(key);
+    });
+    
+    ShardedTree<int> sharded;
+    sharded.set_max_shard_size(16384);
+    double shardedRate = run([&](int key) {
+        sharded.insert(key);
+    });
+    
+    std::cout << "Writers: " << writers << ", inserts per writer: " << perWriter
+              << ", hardware threads: " << std::thread::hardware_concurrency() << std::endl;
+    std::cout << "Tree + mutex: " << lockedRate / 1e6 << " M inserts/s, size " << locked.size() << std::endl;
+    std::cout << "ShardedTree:  " << shardedRate / 1e6 << " M inserts/s, size " << sharded.size()
+              << ", shards " << sharded.shard_count() << std::endl;
+    
+    std::cout << std::endl;
+}
+
+void testPersistentTree() {
+    std::cout << "=== Persistent Tree ===" << std::endl;
+    
+    PersistentTree<int> tree = {50, 30, 70, 20, 40};
+    PersistentTree<int> before = tree.snapshot();
+    tree.insert(60);
+    tree.erase(30);
+    printTree("Snapshot", before);
+    printTree("Current", tree);
+    
+    // Снимок за O(1) против полной копии Tree
+    const int count = 200000;
+    std::vector<int> values(count);
+    for (int i = 0; i < count; ++i) {
+        values[i] = i;
+    }
+    Tree<int> plain(values.begin(), values.end());
+    PersistentTree<int> persistent(values.begin(), values.end());
+    
+    auto start = std::chrono::steady_clock::now();
+    Tree<int> copy(plain);
+    auto middle = std::chrono::steady_clock::now();
+    PersistentTree<int> view = persistent.snapshot();
+    auto finish = std::chrono::steady_clock::now();
+    for (int i = 0; i < 1000; ++i) {
+        persistent.erase(i * 2);
+    }
+    std::cout << "Tree copy: " << std::chrono::duration<double, std::micro>(middle - start).count() << " us, "
+              << "snapshot: " << std::chrono::duration<double, std::micro>(finish - middle).count() << " us" << std::endl;
+    std::cout << "After 1000 erases: current size " << persistent.size() << ", snapshot size " << view.size()
+              << ", snapshot contains 0: " << view.contains(0) << std::endl;
+    
+    std::cout << std::endl;
+}
+
+void testTreeMap() {
+    std::cout << "=== Tree Map ===" << std::endl;
+    
+    TreeMap<std::string, int> wordCount;
+    for (const char* word : {"tree", "map", "tree", "node", "map", "tree"}) {
+        wordCount[word]++;
+    }
+    std::cout << "Counts: ";
+    for (const auto& [word, count] : wordCount) {
+        std::cout << word << "=" << count << " ";
+    }
+    std::cout << std::endl;
+    
+    // try_emplace не трогает существующее значение, insert_or_assign перезаписывает
+    auto [it, inserted] = wordCount.try_emplace("tree", 100);
+    std::cout << "try_emplace(tree): inserted=" << inserted << ", value=" << it->second << std::endl;
+    wordCount.insert_or_assign("node", 42);
+    std::cout << "insert_or_assign(node): " << wordCount.at("node") << std::endl;
+    std::cout << "find(map): " << wordCount.find("map")->second << ", contains(leaf): " << wordCount.contains("leaf") << std::endl;
+    std::cout << "lower_bound(o): " << wordCount.lower_bound("o")->first << std::endl;
+    
+    std::cout << std::endl;
+}
+
+void testTreeMultiset() {
+    std::cout << "=== Tree Multiset ===" << std::endl;
+    
+    // Повторы хранятся счетчиком в одном узле
+    TreeMultiset<int> events;
+    for (int e : {5, 3, 5, 8, 3, 5, 1}) {
+        events.insert(e);
+    }
+    events.insert(8, 3);
+    std::cout << "Elements: ";
+    for (int e : events) {
+        std::cout << e << " ";
+    }
+    std::cout << std::endl;
+    std::cout << "Size: " << events.size() << ", distinct: " << events.distinct_size() << std::endl;
+    std::cout << "count(5): " << events.count(5) << ", count(4): " << events.count(4) << std::endl;
+    
+    auto [first, last] = events.equal_range(8);
+    std::cout << "equal_range(8): " << std::distance(first, last) << " elements" << std::endl;
+    
+    std::cout << "erase(5, 2): " << events.erase(5, 2) << ", count(5): " << events.count(5) << std::endl;
+    std::cout << "erase(3): " << events.erase(3) << ", contains(3): " << events.contains(3) << std::endl;
+    std::cout << "Counts: ";
+    for (auto it = events.distinct_begin(); it != events.distinct_end(); ++it) {
+        std::cout << it->first << "x" << it->second << " ";
+    }
+    std::cout << std::endl;
+    
+    std::cout << std::endl;
+}
+
+// Аллокатор-счетчик для проверки работы пула узлов
+static size_t allocatorCalls = 0;
+
+template <typename T>
+struct CountingAllocator {
+    using value_type = T;
+
+    CountingAllocator() = default;
+    template <typename U>
+    CountingAllocator(const CountingAllocator<U>&) {}
+
+    T* allocate(size_t n) {
+        ++allocatorCalls;
+        return std::allocator<T>().allocate(n);
+    }
+    void deallocate(T* p, size_t n) {
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    template <typename U>
+    bool operator==(const CountingAllocator<U>&) const { return true; }
+    template <typename U>
+    bool operator!=(const CountingAllocator<U>&) const { return false; }
+};
+
+// Аллокатор с состоянием и без конструктора по умолчанию: все выделения идут через арену
+struct Arena {
+    const char* name;
+    size_t allocations = 0;
+};
+
+template <typename T>
+struct ArenaAllocator {
+    using value_type = T;
+    using propagate_on_container_move_assignment = std::true_type;
+
+    Arena* arena;
+
+    explicit ArenaAllocator(Arena* a) : arena(a) {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.arena) {}
+
+    T* allocate(size_t n) {
+        ++arena->allocations;
+        return std::allocator<T>().allocate(n);
+    }
+    void deallocate(T* p, size_t n) {
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& other) const { return arena == other.arena; }
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const { return arena != other.arena; }
+};
+
+void testNodePool() {
+    std::cout << "=== Node Pool Test ===" << std::endl;
+    
+    Tree<int, std::less<int>, CountingAllocator<int>> tree;
+    for (int round = 0; round < 10; ++round) {
+        for (int i = 0; i < 1000; ++i) {
+            tree.insert(i);
+        }
+        for (int i = 0; i < 1000; ++i) {
+            tree.erase(i);
+        }
+    }
+    std::cout << "Insert/erase churn: size=" << tree.size() << ", allocator calls=" << allocatorCalls << std::endl;
+    
+    for (int i = 0; i < 100; ++i) {
+        tree.insert(i);
+    }
+    Tree<int, std::less<int>, CountingAllocator<int>> copy(tree);
+    std::cout << "Copy: size=" << copy.size() << ", first=" << *copy.begin() << std::endl;
+    
+    copy.clear();
+    tree.clear();
+    std::cout << "After clear: size=" << tree.size() << std::endl;
+    
+    // После перемещений аллокатор пользователя сохраняется, а пул пересоздается из него
+    using ArenaTree = Tree<int, std::less<int>, ArenaAllocator<int>>;
+    Arena first{"first"};
+    Arena second{"second"};
+    ArenaTree a{std::less<int>(), ArenaAllocator<int>(&first)};
+    ArenaTree b{std::less<int>(), ArenaAllocator<int>(&second)};
+    for (int i = 0; i < 100; ++i) {
+        b.insert(i);
+    }
+    a = std::move(b);
+    ArenaTree moved(std::move(a));
+    a.insert(1);
+    b.insert(2);
+    std::cout << "Arena after moves: a uses " << a.get_allocator().arena->name << ", b uses " << b.get_allocator().arena->name
+              << ", moved size=" << moved.size() << ", allocations first=" << first.allocations
+              << ", second=" << second.allocations << std::endl;
+    
+    std::cout << std::endl;
+}
+
+void testBinarySnapshot() {
+    std::cout << "=== Binary Snapshot ===" << std::endl;
+    
+    const int count = 500000;
+    std::vector<int> values(count);
+    for (int i = 0; i < count; ++i) {
+        values[i] = i * 3;
+    }
+    Tree<int> tree(values.begin(), values.end());
+    const char* filename = "tree_snapshot.bin";
+    
+    auto start = std::chrono::steady_clock::now();
+    ConstructorsUtil<int>::save(tree, filename);
+    auto saved = std::chrono::steady_clock::now();
+    Tree<int> loaded = ConstructorsUtil<int>::load(filename);
+    auto built = std::chrono::steady_clock::now();
+    MappedTree<int> mapped = ConstructorsUtil<int>::openMapped(filename);
+    auto opened = std::chrono::steady_clock::now();
+    
+    auto ms = [](auto from, auto to) { return std::chrono::duration<double, std::milli>(to - from).count(); };
+    std::cout << "save: " << ms(start, saved) << " ms, load: " << ms(saved, built)
+              << " ms, openMapped: " << ms(built, opened) << " ms" << std::endl;
+    std::cout << "Loaded size: " << loaded.size() << ", equal: " << std::equal(tree.begin(), tree.end(), loaded.begin(), loaded.end())
+              << std::endl;
+    std::cout << "Mapped size: " << mapped.size() << ", contains 300: " << mapped.contains(300)
+              << ", contains 301: " << mapped.contains(301) << ", lower_bound(1000): " << *mapped.lower_bound(1000) << std::endl;
+    
+    // Снимок хранит метку компаратора: открыть его можно только с тем же порядком
+    Tree<int, std::greater<int>> descending(values.begin(), values.end());
+    ConstructorsUtil<int>::save(descending, filename);
+    auto reversed = ConstructorsUtil<int>::openMapped<std::greater<int>>(filename);
+    auto reloaded = ConstructorsUtil<int>::load<std::greater<int>>(filename);
+    std::cout << "Descending snapshot: first=" << *reversed.begin() << ", lower_bound(1000): " << *reversed.lower_bound(1000)
+              << ", loaded first=" << *reloaded.begin() << std::endl;
+    try {
+        ConstructorsUtil<int>::openMapped(filename);
+        std::cout << "Comparator mismatch was not detected" << std::endl;
+    } catch (const std::runtime_error&) {
+        std::cout << "Opening with std::less rejected" << std::endl;
+    }
+    std::remove(filename);
+    
+    std::cout << std::endl;
+}
+
 void testFromFile() {
     std::cout << "=== File Constructor Test ===" << std::endl;
     
@@ -156,6 +1043,11 @@ void testFromFile() {
             std::cout << *it << " ";
         }
         std::cout << std::endl;
+        
+        // Файл уже описывает дерево поиска: узлы связываются как в нем, без вставок
+        Tree<int> shaped = ConstructorsUtil<int>::fromEdgeList("tree_example.txt", true);
+        std::cout << "Shape-preserving import: size=" << shaped.size() << ", equal="
+                  << std::equal(tree.begin(), tree.end(), shaped.begin(), shaped.end()) << std::endl;
     } catch (const std::exception& e) {
         std::cout << "Error: " << e.what() << std::endl;
     }
@@ -163,13 +1055,89 @@ void testFromFile() {
     std::cout << std::endl;
 }
 
+void benchmarkEdgeListParse() {
+    std::cout << "=== Edge List Parse Benchmark ===" << std::endl;
+    
+    // Вырожденное дерево-цепочка: рекурсивный обход переполнил бы стек
+    const int count = 1000000;
+    const char* filename = "edge_list_bench.txt";
+    {
+        std::ofstream out(filename);
+        out << "# value left right\n";
+        for (int i = 1; i <= count; ++i) {
+            out << i << ' ' << 0 << ' ' << (i < count ? i + 1 : 0) << '\n';
+        }
+    }
+    
+    auto start = std::chrono::steady_clock::now();
+    Tree<int> tree = ConstructorsUtil<int>::fromEdgeList(filename);
+    auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::remove(filename);
+    
+    std::cout << "Parsed chain of " << tree.size() << " nodes in " << elapsed << " ms, min=" << *tree.begin()
+              << ", max=" << *std::prev(tree.end()) << std::endl;
+    
+    std::cout << std::endl;
+}
+
+void testEdgeListExport() {
+    std::cout << "=== Edge List Export ===" << std::endl;
+    
+    const int count = 1000000;
+    std::vector<int> values(count);
+    for (int i = 0; i < count; ++i) {
+        values[i] = i + 1;
+    }
+    Tree<int> tree(values.begin(), values.end());
+    const char* filename = "edge_list_export.txt";
+    
+    auto start = std::chrono::steady_clock::now();
+    ConstructorsUtil<int>::toEdgeList(tree, filename);
+    auto written = std::chrono::steady_clock::now();
+    Tree<int> restored = ConstructorsUtil<int>::fromEdgeList(filename, true);
+    auto read = std::chrono::steady_clock::now();
+    std::remove(filename);
+    
+    auto ms = [](auto from, auto to) { return std::chrono::duration<double, std::milli>(to - from).count(); };
+    std::cout << "toEdgeList: " << ms(start, written) << " ms, fromEdgeList (shape): " << ms(written, read) << " ms" << std::endl;
+    std::cout << "Restored size: " << restored.size() << ", equal: "
+              << std::equal(tree.begin(), tree.end(), restored.begin(), restored.end()) << std::endl;
+    
+    std::cout << std::endl;
+}
+
 int main() {
     try {
         testBasicOperations();
         testIterator();
         testSTLAlgorithms();
         testConstructors();
+        testEmplace();
+        testCustomComparator();
+        testBulkConstruction();
+        testOrderStatistics();
+        testRangeAggregate();
+        testSplitJoin();
+        testBatchOperations();
+        testNodeHandles();
+        testThreadedTree();
+        testBTree();
+        testFrozenTree();
+        benchmarkFindMany();
+        testCompactTree();
+        benchmarkCopyDestroy();
+        testConcurrentTree();
+        benchmarkConcurrentTree();
+        testShardedTree();
+        benchmarkShardedInsert();
+        testPersistentTree();
+        testTreeMap();
+        testTreeMultiset();
+        testNodePool();
+        testBinarySnapshot();
         testFromFile();
+        benchmarkEdgeListParse();
+        testEdgeListExport();
         
         std::cout << "All tests completed!" << std::endl;
     } catch (const std::exception& e) {
@@ -0,0 +1,350 @@
+#ifndef TREE_MAP_HPP
+#define TREE_MAP_HPP
+
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include "../tree/tree.hpp"
+
+namespace map_detail {
+
+// Сравнение элементов словаря только по ключу; значения никогда не сравниваются.
+// Прозрачный: дерево ищет по голому ключу без фиктивного значения
+template <typename K, typename V, typename Compare>
+struct KeyCompare {
+    using is_transparent = void;
+    using value_type = std::pair<const K, V>;
+
+    Compare comp;
+
+    KeyCompare() = default;
+    explicit KeyCompare(const Compare& c) : comp(c) {}
+
+    bool operator()(const value_type& a, const value_type& b) const {
+        return comp(a.first, b.first);
+    }
+    bool operator()(const value_type& a, const K& b) const {
+        return comp(a.first, b);
+    }
+    bool operator()(const K& a, const value_type& b) const {
+        return comp(a, b.first);
+    }
+};
+
+} // namespace map_detail
+
+// Упорядоченный словарь на том же красно-черном ядре, что и Tree: элементы -
+// пары (ключ, значение) в узлах Tree, порядок задается только ключом.
+// try_emplace, operator[] и insert_or_assign ищут место по ключу и конструируют
+// значение в узле один раз, только если ключа еще нет.
+template <typename K, typename V, typename Compare = std::less<K>,
+          typename Allocator = std::allocator<std::pair<const K, V>>>
+class TreeMap {
+public:
+    // Типы
+    using key_type = K;
+    using mapped_type = V;
+    using value_type = std::pair<const K, V>;
+    using size_type = size_t;
+    using difference_type = std::ptrdiff_t;
+    using key_compare = Compare;
+    using allocator_type = Allocator;
+
+private:
+    using MapCompare = map_detail::KeyCompare<K, V, Compare>;
+    using Impl = Tree<value_type, MapCompare, Allocator>;
+
+public:
+    using iterator = typename Impl::iterator;
+    using const_iterator = iterator;
+
+    // Сравнение элементов по ключу
+    class value_compare {
+    public:
+        bool operator()(const value_type& a, const value_type& b) const {
+            return comp(a.first, b.first);
+        }
+
+    private:
+        Compare comp;
+
+        explicit value_compare(const Compare& c) : comp(c) {}
+
+        friend class TreeMap;
+    };
+
+    explicit TreeMap(const Compare& comp = Compare(), const Allocator& alloc = Allocator());
+    template <typename InputIt>
+    TreeMap(InputIt first, InputIt last, const Compare& comp = Compare(), const Allocator& alloc = Allocator());
+    TreeMap(std::initializer_list<value_type> init, const Compare& comp = Compare(), const Allocator& alloc = Allocator());
+
+    // Доступ по ключу
+    V& operator[](const K& key);
+    V& operator[](K&& key);
+    V& at(const K& key);
+    const V& at(const K& key) const;
+
+    // Вставка: при существующем ключе insert, emplace и try_emplace ничего не меняют
+    std::pair<iterator, bool> insert(const value_type& value);
+    std::pair<iterator, bool> insert(value_type&& value);
+    template <typename... Args>
+    std::pair<iterator, bool> emplace(Args&&... args);
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace(const K& key, Args&&... args);
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace(K&& key, Args&&... args);
+    template <typename M>
+    std::pair<iterator, bool> insert_or_assign(const K& key, M&& obj);
+    template <typename M>
+    std::pair<iterator, bool> insert_or_assign(K&& key, M&& obj);
+    size_type erase(const K& key);
+    iterator erase(iterator position);
+    void clear();
+
+    // Поиск по ключу
+    iterator find(const K& key) const;
+    iterator lower_bound(const K& key) const;
+    iterator upper_bound(const K& key) const;
+    std::pair<iterator, iterator> equal_range(const K& key) const;
+    size_type count(const K& key) const;
+    bool contains(const K& key) const;
+
+    iterator begin() const;
+    iterator end() const;
+    iterator cbegin() const;
+    iterator cend() const;
+
+    size_type size() const;
+    bool empty() const;
+    allocator_type get_allocator() const;
+    key_compare key_comp() const;
+    value_compare value_comp() const;
+
+private:
+    Impl tree;
+
+    template <typename KeyArg, typename... Args>
+    std::pair<iterator, bool> tryEmplace(KeyArg&& key, Args&&... args);
+    template <typename KeyArg, typename M>
+    std::pair<iterator, bool> insertOrAssign(KeyArg&& key, M&& obj);
+};
+
+// Реализация методов TreeMap
+
+template <typename K, typename V, typename Compare, typename Allocator>
+TreeMap<K, V, Compare, Allocator>::TreeMap(const Compare& comp, const Allocator& alloc)
+    : tree(MapCompare(comp), alloc) {}
+
+template <typename K, typename V, typename Compare, typename Allocator>
+template <typename InputIt>
+TreeMap<K, V, Compare, Allocator>::TreeMap(InputIt first, InputIt last, const Compare& comp, const Allocator& alloc)
+    : TreeMap(comp, alloc) {
+    // Пары с константным ключом не сортируются на месте, поэтому вставка по одной
+    for (; first != last; ++first) {
+        insert(*first);
+    }
+}
+
+template <typename K, typename V, typename Compare, typename Allocator>
+TreeMap<K, V, Compare, Allocator>::TreeMap(std::initializer_list<value_type> init, const Compare& comp,
+                                           const Allocator& alloc)
+    : TreeMap(init.begin(), init.end(), comp, alloc) {}
+
+template <typename K, typename V, typename Compare, typename Allocator>
+V& TreeMap<K, V, Compare, Allocator>::operator[](const K& key) {
+    return tryEmplace(key).first->second;
+}
+
+template <typename K, typename V, typename Compare, typename Allocator>
+V& TreeMap<K, V, Compare, Allocator>::operator[](K&& key) {
+    return tryEmplace(std::move(key)).first->second;
+}
+
+template <typename K, typename V, typename Compare, typename Allocator>
+V& TreeMap<K, V, Compare, Allocator>::at(const K& key) {
+    iterator it = find(key);
+    if (it == end()) {
+        throw std::out_of_range("TreeMap::at: key not found");
+    }
+    return it->second;
+}
+
+template <typename K, typename V, typename Compare, typename Allocator>
+const V& TreeMap<K, V, Compare, Allocator>::at(const K& key) const {
+    iterator it = find(key);
+    if (it == end()) {
+        throw std::out_of_range("TreeMap::at: key not found");
+    }
+    return it->second;
+}
+
+template <typename K, typename V, typename Compare, typename Allocator>
+std::pair<typename TreeMap<K, V, Compare, Allocator>::iterator, bool>
+TreeMap<K, V, Compare, Allocator>::insert(const value_type& value) {
+    return tree.emplaceKey(value.first, value);
+}
+
+template <typename K, typename V, typename Compare, typename Allocator>
+std::pair<typename TreeMap<K, V, Compare, Allocator>::iterator, bool>
+TreeMap<K, V, Compare, Allocator>::insert(value_type&& value) {
+    return tree.emplaceKey(value.first, std::move(value));
+}
+
+template <typename K, typename V, typename Compare, typename Allocator>
+template <typename... Args>
+std::pair<typename TreeMap<K, V, Compare, Allocator>::iterator, bool>
+TreeMap<K, V, Compare, Allocator>::emplace(Args&&... args) {
+    // Ключ известен только после конструирования пары
+    return tree.emplace(std::forward<Args>(args)...);
+}
+
+template <typename K, typename V, typename Compare, typename Allocator>
+template <typename... Args>
+std::pair<typename TreeMap<K, V, Compare, Allocator>::iterator, bool>
+TreeMap<K, V, Compare, Allocator>::try_emplace(const K& key, Args&&... args) {
+    return tryEmplace(key, std::forward<Args>(args)...);
+}
+
+template <typename K, typename V, typename Compare, typename Allocator>
+template <typename... Args>
+std::pair<typename TreeMap<K, V, Compare, Allocator>::iterator, bool>
+TreeMap<K, V, Compare, Allocator>::try_emplace(K&& key, Args&&... args) {
+    return tryEmplace(std::move(key), std::forward<Args>(args)...);
+}
+
+template <typename K, typename V, typename Compare, typename Allocator>
+template <typename M>
+std::pair<typename TreeMap<K, V, Compare, Allocator>::iterator, bool>
+TreeMap<K, V, Compare, Allocator>::insert_or_assign(const K& key, M&& obj) {
+    return insertOrAssign(key, std::forward<M>(obj));
+}
+
+template <typename K, typename V, typename Compare, typename Allocator>
+template <typename M>
+std::pair<typename TreeMap<K, V, Compare, Allocator>::iterator, bool>
+TreeMap<K, V, Compare, Allocator>::insert_or_assign(K&& key, M&& obj) {
+    return insertOrAssign(std::move(key), std::forward<M>(obj));
+}
+
+template <typename K, typename V, typename Compare, typename Allocator>
+typename TreeMap<K, V, Compare, Allocator>::size_type TreeMap<K, V, Compare, Allocator>::erase(const K& key) {
+    return tree.erase(key);
+}
+
+template <typename K, typename V, typename Compare, typename Allocator>
+typename TreeMap<K, V, Compare, Allocator>::iterator TreeMap<K, V, Compare, Allocator>::erase(iterator position) {
+    return tree.erase(position);
+}
+
+template <typename K, typename V, typename Compare, typename Allocator>
+void TreeMap<K, V, Compare, Allocator>::clear() {
+    tree.clear();
+}
+
+template <typename K, typename V, typename Compare, typename Allocator>
+typename TreeMap<K, V, Compare, Allocator>::iterator TreeMap<K, V, Compare, Allocator>::find(const K& key) const {
+    iterator it = tree.lower_bound(key);
+    return it != end() && !tree.key_comp()(key, *it) ? it : end();
+}
+
+template <typename K, typename V, typename Compare, typename Allocator>
+typename TreeMap<K, V, Compare, Allocator>::iterator TreeMap<K, V, Compare, Allocator>::lower_bound(const K& key) const {
+    return tree.lower_bound(key);
+}
+
+template <typename K, typename V, typename Compare, typename Allocator>
+typename TreeMap<K, V, Compare, Allocator>::iterator TreeMap<K, V, Compare, Allocator>::upper_bound(const K& key) const {
+    return tree.upper_bound(key);
+}
+
+template <typename K, typename V, typename Compare, typename Allocator>
+std::pair<typename TreeMap<K, V, Compare, Allocator>::iterator, typename TreeMap<K, V, Compare, Allocator>::iterator>
+TreeMap<K, V, Compare, Allocator>::equal_range(const K& key) const {
+    return tree.equal_range(key);
+}
+
+template <typename K, typename V, typename Compare, typename Allocator>
+typename TreeMap<K, V, Compare, Allocator>::size_type TreeMap<K, V, Compare, Allocator>::count(const K& key) const {
+    return tree.count(key);
+}
+
+template <typename K, typename V, typename Compare, typename Allocator>
+bool TreeMap<K, V, Compare, Allocator>::contains(const K& key) const {
+    return tree.contains(key);
+}
+
+template <typename K, typename V, typename Compare, typename Allocator>
+typename TreeMap<K, V, Compare, Allocator>::iterator TreeMap<K, V, Compare, Allocator>::begin() const {
+    return tree.begin();
+}
+
+template <typename K, typename V, typename Compare, typename Allocator>
+typename TreeMap<K, V, Compare, Allocator>::iterator TreeMap<K, V, Compare, Allocator>::end() const {
+    return tree.end();
+}
+
+template <typename K, typename V, typename Compare, typename Allocator>
+typename TreeMap<K, V, Compare, Allocator>::iterator TreeMap<K, V, Compare, Allocator>::cbegin() const {
+    return begin();
+}
+
+template <typename K, typename V, typename Compare, typename Allocator>
+typename TreeMap<K, V, Compare, Allocator>::iterator TreeMap<K, V, Compare, Allocator>::cend() const {
+    return end();
+}
+
+template <typename K, typename V, typename Compare, typename Allocator>
+typename TreeMap<K, V, Compare, Allocator>::size_type TreeMap<K, V, Compare, Allocator>::size() const {
+    return tree.size();
+}
+
+template <typename K, typename V, typename Compare, typename Allocator>
+bool TreeMap<K, V, Compare, Allocator>::empty() const {
+    return tree.empty();
+}
+
+template <typename K, typename V, typename Compare, typename Allocator>
+typename TreeMap<K, V, Compare, Allocator>::allocator_type TreeMap<K, V, Compare, Allocator>::get_allocator() const {
+    return tree.get_allocator();
+}
+
+template <typename K, typename V, typename Compare, typename Allocator>
+typename TreeMap<K, V, Compare, Allocator>::key_compare TreeMap<K, V, Compare, Allocator>::key_comp() const {
+    return tree.key_comp().comp;
+}
+
+template <typename K, typename V, typename Compare, typename Allocator>
+typename TreeMap<K, V, Compare, Allocator>::value_compare TreeMap<K, V, Compare, Allocator>::value_comp() const {
+    return value_compare(key_comp());
+}
+
+// Вспомогательные методы
+
+template <typename K, typename V, typename Compare, typename Allocator>
+template <typename KeyArg, typename... Args>
+std::pair<typename TreeMap<K, V, Compare, Allocator>::iterator, bool>
+TreeMap<K, V, Compare, Allocator>::tryEmplace(KeyArg&& key, Args&&... args) {
+    // Место ищется до конструирования: при существующем ключе key и args не трогаются
+    return tree.emplaceKey(static_cast<const K&>(key), std::piecewise_construct,
+                           std::forward_as_tuple(std::forward<KeyArg>(key)),
+                           std::forward_as_tuple(std::forward<Args>(args)...));
+}
+
+template <typename K, typename V, typename Compare, typename Allocator>
+template <typename KeyArg, typename M>
+std::pair<typename TreeMap<K, V, Compare, Allocator>::iterator, bool>
+TreeMap<K, V, Compare, Allocator>::insertOrAssign(KeyArg&& key, M&& obj) {
+    auto result = tree.emplaceKey(static_cast<const K&>(key), std::piecewise_construct,
+                                  std::forward_as_tuple(std::forward<KeyArg>(key)),
+                                  std::forward_as_tuple(std::forward<M>(obj)));
+    if (!result.second) {
+        result.first->second = std::forward<M>(obj);
+    }
+    return result;
+}
+
+#endif // TREE_MAP_HPP
@@ -0,0 +1,253 @@
+#ifndef TREE_MULTISET_HPP
+#define TREE_MULTISET_HPP
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <utility>
+#include "../map/tree_map.hpp"
+#include "../iterator/multiset_iterator.hpp"
+
+// Мультимножество со счетчиком повторений в узле: равные значения хранятся одним
+// элементом TreeMap<T, size_type>, поэтому вставка, count, equal_range и erase
+// обходятся одним спуском по дереву, а память не растет с числом повторений.
+// Итератор выдает каждое значение столько раз, сколько оно встречается
+// (как std::multiset); distinct_begin()/distinct_end() обходят пары (значение, счетчик).
+template <typename T, typename Compare = std::less<T>, typename Allocator = std::allocator<T>>
+class TreeMultiset {
+public:
+    // Типы
+    using value_type = T;
+    using key_type = T;
+    using size_type = size_t;
+    using difference_type = std::ptrdiff_t;
+    using key_compare = Compare;
+    using value_compare = Compare;
+    using allocator_type = Allocator;
+
+private:
+    using CountAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<std::pair<const T, size_type>>;
+    using Counts = TreeMap<T, size_type, Compare, CountAllocator>;
+
+public:
+    using iterator = MultisetIterator<typename Counts::iterator>;
+    using const_iterator = iterator;
+    using distinct_iterator = typename Counts::iterator;
+
+    explicit TreeMultiset(const Compare& comp = Compare(), const Allocator& alloc = Allocator());
+    template <typename InputIt>
+    TreeMultiset(InputIt first, InputIt last, const Compare& comp = Compare(), const Allocator& alloc = Allocator());
+
+    // Вставка одного или n повторений; итератор указывает на последнее повторение
+    iterator insert(const T& value);
+    iterator insert(T&& value);
+    iterator insert(const T& value, size_type n);
+
+    // Удаление всех повторений или не более n; возвращает число удаленных
+    size_type erase(const T& value);
+    size_type erase(const T& value, size_type n);
+    void clear();
+
+    // Поиск, O(log n) по числу различных значений
+    size_type count(const T& value) const;
+    bool contains(const T& value) const;
+    iterator find(const T& value) const;
+    iterator lower_bound(const T& value) const;
+    iterator upper_bound(const T& value) const;
+    std::pair<iterator, iterator> equal_range(const T& value) const;
+
+    iterator begin() const;
+    iterator end() const;
+    iterator cbegin() const;
+    iterator cend() const;
+    distinct_iterator distinct_begin() const;
+    distinct_iterator distinct_end() const;
+
+    // size() - все повторения, distinct_size() - различные значения
+    size_type size() const;
+    size_type distinct_size() const;
+    bool empty() const;
+    allocator_type get_allocator() const;
+    key_compare key_comp() const;
+
+private:
+    Counts counts;
+    size_type total;
+
+    template <typename V>
+    iterator insertCount(V&& value, size_type n);
+};
+
+// Реализация методов TreeMultiset
+
+template <typename T, typename Compare, typename Allocator>
+TreeMultiset<T, Compare, Allocator>::TreeMultiset(const Compare& comp, const Allocator& alloc)
+    : counts(comp, CountAllocator(alloc)), total(0) {}
+
+template <typename T, typename Compare, typename Allocator>
+template <typename InputIt>
+TreeMultiset<T, Compare, Allocator>::TreeMultiset(InputIt first, InputIt last, const Compare& comp, const Allocator& alloc)
+    : TreeMultiset(comp, alloc) {
+    for (; first != last; ++first) {
+        insert(*first);
+    }
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename TreeMultiset<T, Compare, Allocator>::iterator TreeMultiset<T, Compare, Allocator>::insert(const T& value) {
+    return insertCount(value, 1);
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename TreeMultiset<T, Compare, Allocator>::iterator TreeMultiset<T, Compare, Allocator>::insert(T&& value) {
+    return insertCount(std::move(value), 1);
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename TreeMultiset<T, Compare, Allocator>::iterator TreeMultiset<T, Compare, Allocator>::insert(const T& value, size_type n) {
+    if (n == 0) {
+        return find(value);
+    }
+    return insertCount(value, n);
+}
+
+template <typename T, typename Compare, typename Allocator>
+template <typename V>
+typename TreeMultiset<T, Compare, Allocator>::iterator TreeMultiset<T, Compare, Allocator>::insertCount(V&& value, size_type n) {
+    // Один спуск: узел со счетчиком 0 создается, только если значения еще нет
+    auto it = counts.try_emplace(std::forward<V>(value), 0).first;
+    it->second += n;
+    total += n;
+    return iterator(it, it->second - 1);
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename TreeMultiset<T, Compare, Allocator>::size_type TreeMultiset<T, Compare, Allocator>::erase(const T& value) {
+    auto it = counts.find(value);
+    if (it == counts.end()) {
+        return 0;
+    }
+    size_type removed = it->second;
+    counts.erase(it);
+    total -= removed;
+    return removed;
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename TreeMultiset<T, Compare, Allocator>::size_type TreeMultiset<T, Compare, Allocator>::erase(const T& value, size_type n) {
+    auto it = counts.find(value);
+    if (it == counts.end() || n == 0) {
+        return 0;
+    }
+    // Узел удаляется по итератору, без второго спуска
+    size_type removed = n < it->second ? n : it->second;
+    if (removed == it->second) {
+        counts.erase(it);
+    } else {
+        it->second -= removed;
+    }
+    total -= removed;
+    return removed;
+}
+
+template <typename T, typename Compare, typename Allocator>
+void TreeMultiset<T, Compare, Allocator>::clear() {
+    counts.clear();
+    total = 0;
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename TreeMultiset<T, Compare, Allocator>::size_type TreeMultiset<T, Compare, Allocator>::count(const T& value) const {
+    auto it = counts.find(value);
+    return it == counts.end() ? 0 : it->second;
+}
+
+template <typename T, typename Compare, typename Allocator>
+bool TreeMultiset<T, Compare, Allocator>::contains(const T& value) const {
+    return counts.contains(value);
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename TreeMultiset<T, Compare, Allocator>::iterator TreeMultiset<T, Compare, Allocator>::find(const T& value) const {
+    return iterator(counts.find(value), 0);
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename TreeMultiset<T, Compare, Allocator>::iterator TreeMultiset<T, Compare, Allocator>::lower_bound(const T& value) const {
+    return iterator(counts.lower_bound(value), 0);
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename TreeMultiset<T, Compare, Allocator>::iterator TreeMultiset<T, Compare, Allocator>::upper_bound(const T& value) const {
+    return iterator(counts.upper_bound(value), 0);
+}
+
+template <typename T, typename Compare, typename Allocator>
+std::pair<typename TreeMultiset<T, Compare, Allocator>::iterator, typename TreeMultiset<T, Compare, Allocator>::iterator>
+TreeMultiset<T, Compare, Allocator>::equal_range(const T& value) const {
+    // Все повторения лежат в одном узле: конец диапазона - следующий узел
+    auto it = counts.lower_bound(value);
+    if (it == counts.end() || key_comp()(value, it->first)) {
+        return {iterator(it, 0), iterator(it, 0)};
+    }
+    auto next = it;
+    ++next;
+    return {iterator(it, 0), iterator(next, 0)};
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename TreeMultiset<T, Compare, Allocator>::iterator TreeMultiset<T, Compare, Allocator>::begin() const {
+    return iterator(counts.begin(), 0);
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename TreeMultiset<T, Compare, Allocator>::iterator TreeMultiset<T, Compare, Allocator>::end() const {
+    return iterator(counts.end(), 0);
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename TreeMultiset<T, Compare, Allocator>::iterator TreeMultiset<T, Compare, Allocator>::cbegin() const {
+    return begin();
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename TreeMultiset<T, Compare, Allocator>::iterator TreeMultiset<T, Compare, Allocator>::cend() const {
+    return end();
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename TreeMultiset<T, Compare, Allocator>::distinct_iterator TreeMultiset<T, Compare, Allocator>::distinct_begin() const {
+    return counts.begin();
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename TreeMultiset<T, Compare, Allocator>::distinct_iterator TreeMultiset<T, Compare, Allocator>::distinct_end() const {
+    return counts.end();
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename TreeMultiset<T, Compare, Allocator>::size_type TreeMultiset<T, Compare, Allocator>::size() const {
+    return total;
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename TreeMultiset<T, Compare, Allocator>::size_type TreeMultiset<T, Compare, Allocator>::distinct_size() const {
+    return counts.size();
+}
+
+template <typename T, typename Compare, typename Allocator>
+bool TreeMultiset<T, Compare, Allocator>::empty() const {
+    return total == 0;
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename TreeMultiset<T, Compare, Allocator>::allocator_type TreeMultiset<T, Compare, Allocator>::get_allocator() const {
+    return allocator_type(counts.get_allocator());
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename TreeMultiset<T, Compare, Allocator>::key_compare TreeMultiset<T, Compare, Allocator>::key_comp() const {
+    return counts.key_comp();
+}
+
+#endif // TREE_MULTISET_HPP
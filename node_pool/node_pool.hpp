@@ -0,0 +1,187 @@
+#ifndef NODE_POOL_HPP
+#define NODE_POOL_HPP
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+// Пул узлов: узлы нарезаются из непрерывных блоков (слэбов),
+// освобожденные узлы переиспользуются через список свободных.
+// Allocator - любой std-совместимый аллокатор, перепривязывается на Node.
+// Пул может разделяться несколькими деревьями (после split/join): тогда
+// он помечается общим и операции с ним защищаются мьютексом.
+template <typename Node, typename Allocator>
+class NodePool {
+public:
+    using allocator_type = typename std::allocator_traits<Allocator>::template rebind_alloc<Node>;
+    using size_type = std::size_t;
+
+    explicit NodePool(const allocator_type& alloc = allocator_type())
+        : alloc(alloc), freeList(nullptr), cursor(nullptr), slabEnd(nullptr), nextSlabSize(MIN_SLAB), shared(false) {}
+
+    NodePool(const NodePool&) = delete;
+    NodePool& operator=(const NodePool&) = delete;
+
+    ~NodePool() {
+        release();
+    }
+
+    // Создание узла на месте
+    template <typename... Args>
+    Node* create(Args&&... args) {
+        Node* p;
+        {
+            auto lock = guard();
+            p = allocate();
+        }
+        try {
+            std::allocator_traits<allocator_type>::construct(alloc, p, std::forward<Args>(args)...);
+        } catch (...) {
+            auto lock = guard();
+            deallocate(p);
+            throw;
+        }
+        return p;
+    }
+
+    // Уничтожение узла и возврат памяти в список свободных
+    void destroy(Node* p) {
+        std::allocator_traits<allocator_type>::destroy(alloc, p);
+        auto lock = guard();
+        deallocate(p);
+    }
+
+    // Уничтожение узла без возврата памяти: перед release() всего пула.
+    // Список свободных не трогает, поэтому безопасно из нескольких потоков
+    void destroyInPlace(Node* p) {
+        std::allocator_traits<allocator_type>::destroy(alloc, p);
+    }
+
+    // Гарантирует, что следующие n узлов будут выданы без обращения к аллокатору
+    void reserve(size_type n) {
+        auto lock = guard();
+        size_type available = static_cast<size_type>(slabEnd - cursor);
+        if (n > available) {
+            addSlab(n - available > MIN_SLAB ? n - available : MIN_SLAB);
+        }
+    }
+
+    // Освобождает все слэбы разом. Деструкторы узлов не вызываются.
+    void release() noexcept {
+        for (auto& slab : slabs) {
+            std::allocator_traits<allocator_type>::deallocate(alloc, slab.first, slab.second);
+        }
+        slabs.clear();
+        freeList = nullptr;
+        cursor = nullptr;
+        slabEnd = nullptr;
+        nextSlabSize = MIN_SLAB;
+    }
+
+    // Забирает слэбы и свободные узлы другого пула (узлы other становятся узлами этого пула).
+    // Возможно только при равных аллокаторах.
+    bool absorb(NodePool& other) {
+        if (this == &other) {
+            return true;
+        }
+        if (!(alloc == other.alloc)) {
+            return false;
+        }
+        std::scoped_lock lock(mutex, other.mutex);
+        while (other.cursor != other.slabEnd) {
+            other.deallocate(other.cursor++);
+        }
+        if (other.freeList) {
+            FreeSlot* tail = other.freeList;
+            while (tail->next) {
+                tail = tail->next;
+            }
+            tail->next = freeList;
+            freeList = other.freeList;
+        }
+        slabs.insert(slabs.end(), other.slabs.begin(), other.slabs.end());
+        other.reset();
+        return true;
+    }
+
+    // Пул стал общим для нескольких деревьев. Повторная пометка ничего не пишет:
+    // общий пул уже могут использовать другие потоки
+    void markShared() {
+        if (!shared) {
+            shared = true;
+        }
+    }
+
+    allocator_type get_allocator() const {
+        return alloc;
+    }
+
+private:
+    static constexpr size_type MIN_SLAB = 32;
+    static constexpr size_type MAX_SLAB = 8192;
+
+    // Свободный узел хранит указатель на следующий свободный в своей памяти
+    struct FreeSlot {
+        FreeSlot* next;
+    };
+    static_assert(sizeof(Node) >= sizeof(FreeSlot), "Node is too small for the free list");
+
+    allocator_type alloc;
+    std::vector<std::pair<Node*, size_type>> slabs;
+    FreeSlot* freeList;
+    Node* cursor;
+    Node* slabEnd;
+    size_type nextSlabSize;
+    bool shared;
+    std::mutex mutex;
+
+    // Блокировка нужна только общему пулу
+    std::unique_lock<std::mutex> guard() {
+        return shared ? std::unique_lock<std::mutex>(mutex) : std::unique_lock<std::mutex>();
+    }
+
+    Node* allocate() {
+        if (freeList) {
+            FreeSlot* slot = freeList;
+            freeList = slot->next;
+            slot->~FreeSlot();
+            return reinterpret_cast<Node*>(slot);
+        }
+        if (cursor == slabEnd) {
+            addSlab(nextSlabSize);
+            if (nextSlabSize < MAX_SLAB) {
+                nextSlabSize *= 2;
+            }
+        }
+        return cursor++;
+    }
+
+    void deallocate(Node* p) noexcept {
+        freeList = ::new (static_cast<void*>(p)) FreeSlot{freeList};
+    }
+
+    void addSlab(size_type count) {
+        // Остаток текущего слэба уходит в список свободных
+        while (cursor != slabEnd) {
+            deallocate(cursor++);
+        }
+        slabs.reserve(slabs.size() + 1);
+        Node* slab = std::allocator_traits<allocator_type>::allocate(alloc, count);
+        slabs.emplace_back(slab, count);
+        cursor = slab;
+        slabEnd = slab + count;
+    }
+
+    void reset() noexcept {
+        slabs.clear();
+        freeList = nullptr;
+        cursor = nullptr;
+        slabEnd = nullptr;
+        nextSlabSize = MIN_SLAB;
+    }
+};
+
+#endif // NODE_POOL_HPP
@@ -0,0 +1,179 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Пул потоков для fork-join рекурсии по независимым поддеревьям.
+// invoke(f, g) отдает f пулу и выполняет g в текущем потоке; если к моменту
+// ожидания f еще не взята рабочим потоком, она выполняется здесь же.
+// Поэтому вложенные invoke не блокируют пул, даже когда все потоки заняты.
+class ThreadPool {
+public:
+    explicit ThreadPool(std::size_t threads) : stopping(false) {
+        for (std::size_t i = 0; i < threads; ++i) {
+            workers.emplace_back([this] { workerLoop(); });
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            stopping = true;
+        }
+        queueReady.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    // Общий пул процесса: по одному потоку на ядро, кроме текущего
+    static ThreadPool& instance() {
+        static ThreadPool pool(std::max<std::size_t>(1, std::thread::hardware_concurrency()) - 1);
+        return pool;
+    }
+
+    std::size_t size() const {
+        return workers.size();
+    }
+
+    // Глубина рекурсии, до которой имеет смысл делить работу
+    std::size_t parallelDepth() const {
+        std::size_t depth = 0;
+        while ((std::size_t(1) << depth) <= workers.size()) {
+            depth++;
+        }
+        return workers.empty() ? 0 : depth + 1;
+    }
+
+    template <typename F, typename G>
+    void invoke(F&& f, G&& g) {
+        if (workers.empty()) {
+            f();
+            g();
+            return;
+        }
+
+        auto task = std::make_shared<Task>();
+        task->fn = std::forward<F>(f);
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            queue.push_back(task);
+        }
+        queueReady.notify_one();
+
+        std::exception_ptr error;
+        try {
+            g();
+        } catch (...) {
+            error = std::current_exception();
+        }
+
+        if (task->tryStart()) {
+            task->run();
+        } else {
+            task->wait();
+        }
+
+        if (error) {
+            std::rethrow_exception(error);
+        }
+        if (task->error) {
+            std::rethrow_exception(task->error);
+        }
+    }
+
+    // Задача без ожидания результата (например, фоновое освобождение памяти).
+    // Без рабочих потоков выполняется сразу; ошибки задачи игнорируются.
+    // Оставшиеся задачи выполняются до остановки пула
+    template <typename F>
+    void post(F&& f) {
+        if (workers.empty()) {
+            try {
+                f();
+            } catch (...) {
+            }
+            return;
+        }
+        auto task = std::make_shared<Task>();
+        task->fn = std::forward<F>(f);
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            queue.push_back(task);
+        }
+        queueReady.notify_one();
+    }
+
+private:
+    struct Task {
+        enum State { PENDING, RUNNING, DONE };
+
+        std::function<void()> fn;
+        std::atomic<int> state{PENDING};
+        std::exception_ptr error;
+        std::mutex doneMutex;
+        std::condition_variable doneSignal;
+
+        bool tryStart() {
+            int expected = PENDING;
+            return state.compare_exchange_strong(expected, RUNNING);
+        }
+
+        void run() {
+            try {
+                fn();
+            } catch (...) {
+                error = std::current_exception();
+            }
+            {
+                std::lock_guard<std::mutex> lock(doneMutex);
+                state = DONE;
+            }
+            doneSignal.notify_all();
+        }
+
+        void wait() {
+            std::unique_lock<std::mutex> lock(doneMutex);
+            doneSignal.wait(lock, [this] { return state == DONE; });
+        }
+    };
+
+    std::vector<std::thread> workers;
+    std::deque<std::shared_ptr<Task>> queue;
+    std::mutex queueMutex;
+    std::condition_variable queueReady;
+    bool stopping;
+
+    void workerLoop() {
+        while (true) {
+            std::shared_ptr<Task> task;
+            {
+                std::unique_lock<std::mutex> lock(queueMutex);
+                queueReady.wait(lock, [this] { return stopping || !queue.empty(); });
+                if (queue.empty()) {
+                    return;
+                }
+                task = std::move(queue.front());
+                queue.pop_front();
+            }
+            // Задачу мог уже забрать вызвавший invoke поток
+            if (task->tryStart()) {
+                task->run();
+            }
+        }
+    }
+};
+
+#endif // THREAD_POOL_HPP
@@ -0,0 +1,225 @@
+#ifndef COW_LLRB_HPP
+#define COW_LLRB_HPP
+
+#include <utility>
+
+namespace persistent_detail {
+
+// Левонаклонное красно-черное дерево (LLRB, Sedgewick) с копированием при записи.
+// Алгоритмы не меняют узлы, видимые другим версиям дерева: каждый изменяемый узел
+// сначала проходит через cow.own(node), который возвращает его изменяемую копию
+// (или сам узел, если он уже принадлежит текущей записи).
+//
+// Node: val, left, right, red; пустое поддерево - nullptr.
+// Cow:
+//   Node* own(Node* node);     // изменяемая версия node; старую версию cow учитывает сам
+//   Node* make(V&& value);     // новый красный узел
+//   void drop(Node* node);     // узел больше не входит в новую версию; ссылки на его
+//                              // детей к этому моменту уже переданы другим узлам
+template <typename Node, typename Compare>
+struct CowLlrb {
+    static bool isRed(const Node* node) {
+        return node != nullptr && node->red;
+    }
+
+    // Поиск только читает узлы
+    template <typename K>
+    static const Node* lowerBound(const Node* node, const K& key, const Compare& comp) {
+        const Node* candidate = nullptr;
+        while (node != nullptr) {
+            if (!comp(node->val, key)) {
+                candidate = node;
+                node = node->left;
+            } else {
+                node = node->right;
+            }
+        }
+        return candidate;
+    }
+
+    template <typename K>
+    static const Node* upperBound(const Node* node, const K& key, const Compare& comp) {
+        const Node* candidate = nullptr;
+        while (node != nullptr) {
+            if (comp(key, node->val)) {
+                candidate = node;
+                node = node->left;
+            } else {
+                node = node->right;
+            }
+        }
+        return candidate;
+    }
+
+    template <typename K>
+    static const Node* find(const Node* node, const K& key, const Compare& comp) {
+        const Node* candidate = lowerBound(node, key, comp);
+        return candidate != nullptr && !comp(key, candidate->val) ? candidate : nullptr;
+    }
+
+    static const Node* minimum(const Node* node) {
+        while (node != nullptr && node->left != nullptr) {
+            node = node->left;
+        }
+        return node;
+    }
+
+    // Вставка ключа, которого нет в дереве; возвращает новый корень
+    template <typename Cow, typename V>
+    static Node* insert(Cow& cow, Node* root, V&& value, const Compare& comp) {
+        root = insertAt(cow, root, std::forward<V>(value), comp);
+        return blacken(cow, root);
+    }
+
+    // Удаление ключа, который есть в дереве; возвращает новый корень (nullptr, если дерево опустело)
+    template <typename Cow, typename K>
+    static Node* erase(Cow& cow, Node* root, const K& key, const Compare& comp) {
+        if (!isRed(root->left) && !isRed(root->right)) {
+            root = cow.own(root);
+            root->red = true;
+        }
+        root = eraseAt(cow, root, key, comp);
+        return root != nullptr ? blacken(cow, root) : nullptr;
+    }
+
+private:
+    template <typename Cow>
+    static Node* blacken(Cow& cow, Node* root) {
+        if (root->red) {
+            root = cow.own(root);
+            root->red = false;
+        }
+        return root;
+    }
+
+    // Вращения и перекраска: h уже изменяемый, затронутые дети копируются здесь
+    template <typename Cow>
+    static Node* rotateLeft(Cow& cow, Node* h) {
+        Node* x = cow.own(h->right);
+        h->right = x->left;
+        x->left = h;
+        x->red = h->red;
+        h->red = true;
+        return x;
+    }
+
+    template <typename Cow>
+    static Node* rotateRight(Cow& cow, Node* h) {
+        Node* x = cow.own(h->left);
+        h->left = x->right;
+        x->right = h;
+        x->red = h->red;
+        h->red = true;
+        return x;
+    }
+
+    template <typename Cow>
+    static void flipColors(Cow& cow, Node* h) {
+        h->left = cow.own(h->left);
+        h->right = cow.own(h->right);
+        h->red = !h->red;
+        h->left->red = !h->left->red;
+        h->right->red = !h->right->red;
+    }
+
+    template <typename Cow>
+    static Node* balance(Cow& cow, Node* h) {
+        if (isRed(h->right) && !isRed(h->left)) {
+            h = rotateLeft(cow, h);
+        }
+        if (isRed(h->left) && isRed(h->left->left)) {
+            h = rotateRight(cow, h);
+        }
+        if (isRed(h->left) && isRed(h->right)) {
+            flipColors(cow, h);
+        }
+        return h;
+    }
+
+    template <typename Cow>
+    static Node* moveRedLeft(Cow& cow, Node* h) {
+        flipColors(cow, h);
+        if (isRed(h->right->left)) {
+            h->right = rotateRight(cow, h->right);
+            h = rotateLeft(cow, h);
+            flipColors(cow, h);
+        }
+        return h;
+    }
+
+    template <typename Cow>
+    static Node* moveRedRight(Cow& cow, Node* h) {
+        flipColors(cow, h);
+        if (isRed(h->left->left)) {
+            h = rotateRight(cow, h);
+            flipColors(cow, h);
+        }
+        return h;
+    }
+
+    template <typename Cow, typename V>
+    static Node* insertAt(Cow& cow, Node* h, V&& value, const Compare& comp) {
+        if (h == nullptr) {
+            return cow.make(std::forward<V>(value));
+        }
+        h = cow.own(h);
+        if (comp(value, h->val)) {
+            h->left = insertAt(cow, h->left, std::forward<V>(value), comp);
+        } else {
+            h->right = insertAt(cow, h->right, std::forward<V>(value), comp);
+        }
+        return balance(cow, h);
+    }
+
+    template <typename Cow>
+    static Node* eraseMin(Cow& cow, Node* h) {
+        if (h->left == nullptr) {
+            cow.drop(h);
+            return nullptr;
+        }
+        h = cow.own(h);
+        if (!isRed(h->left) && !isRed(h->left->left)) {
+            h = moveRedLeft(cow, h);
+        }
+        h->left = eraseMin(cow, h->left);
+        return balance(cow, h);
+    }
+
+    template <typename Cow, typename K>
+    static Node* eraseAt(Cow& cow, Node* h, const K& key, const Compare& comp) {
+        h = cow.own(h);
+        if (comp(key, h->val)) {
+            if (!isRed(h->left) && !isRed(h->left->left)) {
+                h = moveRedLeft(cow, h);
+            }
+            h->left = eraseAt(cow, h->left, key, comp);
+        } else {
+            if (isRed(h->left)) {
+                h = rotateRight(cow, h);
+            }
+            if (!comp(h->val, key) && h->right == nullptr) {
+                cow.drop(h);
+                return nullptr;
+            }
+            if (!isRed(h->right) && !isRed(h->right->left)) {
+                h = moveRedRight(cow, h);
+            }
+            if (!comp(h->val, key)) {
+                // Место удаляемого узла занимает копия минимума правого поддерева
+                Node* replacement = cow.make(minimum(h->right)->val);
+                replacement->left = h->left;
+                replacement->right = eraseMin(cow, h->right);
+                replacement->red = h->red;
+                cow.drop(h);
+                h = replacement;
+            } else {
+                h->right = eraseAt(cow, h->right, key, comp);
+            }
+        }
+        return balance(cow, h);
+    }
+};
+
+} // namespace persistent_detail
+
+#endif // COW_LLRB_HPP
@@ -0,0 +1,421 @@
+#ifndef PERSISTENT_TREE_HPP
+#define PERSISTENT_TREE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "cow_llrb.hpp"
+#include "../node_pool/node_pool.hpp"
+#include "../iterator/stack_iterator.hpp"
+
+// Персистентное дерево: версии разделяют неизменившиеся узлы.
+// snapshot() и копирование - O(1): новая версия ссылается на тот же корень.
+// insert/erase копируют только путь O(log n), который затрагивают (LLRB с копированием
+// при записи); узел, на который ссылается лишь текущая версия, меняется на месте.
+// Узлы освобождаются по счетчику ссылок, когда их не видит ни одна версия.
+//
+// Разные версии можно читать и менять из разных потоков одновременно (как разные
+// shared_ptr на общий объект); одну версию - как обычный контейнер.
+// T должен быть копируемым. Если копирование T бросает исключение посреди записи,
+// версия, в которую шла запись, остается в неопределенном состоянии; остальные версии не затронуты.
+template <typename T, typename Compare = std::less<T>, typename Allocator = std::allocator<T>>
+class PersistentTree {
+private:
+    struct Node;
+
+public:
+    // Типы
+    using iterator = StackIterator<Node, T>;
+    using const_iterator = iterator;
+    using value_type = T;
+    using key_type = T;
+    using size_type = size_t;
+    using key_compare = Compare;
+    using value_compare = Compare;
+    using allocator_type = Allocator;
+    using difference_type = std::ptrdiff_t;
+
+    explicit PersistentTree(const Compare& comp = Compare(), const Allocator& alloc = Allocator());
+    template <typename InputIt>
+    PersistentTree(InputIt first, InputIt last, const Compare& comp = Compare(), const Allocator& alloc = Allocator());
+    PersistentTree(std::initializer_list<T> init, const Compare& comp = Compare(), const Allocator& alloc = Allocator());
+    // Копия - снимок за O(1)
+    PersistentTree(const PersistentTree& other);
+    PersistentTree(PersistentTree&& other) noexcept;
+    ~PersistentTree();
+
+    PersistentTree& operator=(const PersistentTree& other);
+    PersistentTree& operator=(PersistentTree&& other) noexcept;
+
+    // Снимок текущей версии за O(1); дальнейшие записи в него не попадают
+    PersistentTree snapshot() const;
+
+    // Запись копирует только затронутый путь
+    bool insert(const T& value);
+    bool insert(T&& value);
+    template <typename... Args>
+    bool emplace(Args&&... args);
+    size_type erase(const T& value);
+    void clear();
+    void swap(PersistentTree& other) noexcept;
+
+    // Поиск за O(log n)
+    iterator find(const T& value) const;
+    iterator lower_bound(const T& value) const;
+    iterator upper_bound(const T& value) const;
+    std::pair<iterator, iterator> equal_range(const T& value) const;
+    size_type count(const T& value) const;
+    bool contains(const T& value) const;
+
+    // Обход по возрастанию (итераторы действительны до записи в эту версию)
+    iterator begin() const;
+    iterator end() const;
+    iterator cbegin() const;
+    iterator cend() const;
+
+    size_type size() const;
+    bool empty() const;
+    allocator_type get_allocator() const;
+    key_compare key_comp() const;
+
+private:
+    struct Node {
+        T val;
+        Node* left;
+        Node* right;
+        bool red;
+        std::atomic<std::uint32_t> refs;  // число ссылок: родители во всех версиях и корни версий
+
+        template <typename... Args>
+        explicit Node(Args&&... args)
+            : val(std::forward<Args>(args)...), left(nullptr), right(nullptr), red(true), refs(1) {}
+    };
+
+    using Llrb = persistent_detail::CowLlrb<Node, Compare>;
+    using Pool = NodePool<Node, Allocator>;
+
+    // Запись в эту версию: узел с единственной ссылкой уже принадлежит ей
+    class Writer {
+    public:
+        explicit Writer(PersistentTree& t) : tree(t) {}
+
+        Node* own(Node* node);
+        template <typename V>
+        Node* make(V&& value);
+        void drop(Node* node);
+
+    private:
+        PersistentTree& tree;
+    };
+
+    Node* root;
+    size_type treeSize;
+    Compare comp;
+    std::shared_ptr<Pool> pool;  // общий для всех версий; после первого снимка защищен мьютексом
+    Allocator alloc;  // из него пересоздается пул перемещенного дерева
+
+    Pool& nodePool();
+
+    static Node* retain(Node* node);
+    void release(Node* node);
+    template <typename V>
+    bool insertValue(V&& value);
+    template <typename Path>
+    iterator boundPath(Path goesLeft) const;
+};
+
+// Реализация методов Writer
+
+template <typename T, typename Compare, typename Allocator>
+typename PersistentTree<T, Compare, Allocator>::Node*
+PersistentTree<T, Compare, Allocator>::Writer::own(Node* node) {
+    if (node->refs.load(std::memory_order_acquire) == 1) {
+        return node;
+    }
+    // Узел виден и другим версиям: копия забирает ссылки на детей, оригинал теряет нашу
+    Node* copy = make(node->val);
+    copy->left = retain(node->left);
+    copy->right = retain(node->right);
+    copy->red = node->red;
+    tree.release(node);
+    return copy;
+}
+
+template <typename T, typename Compare, typename Allocator>
+template <typename V>
+typename PersistentTree<T, Compare, Allocator>::Node*
+PersistentTree<T, Compare, Allocator>::Writer::make(V&& value) {
+    return tree.nodePool().create(std::forward<V>(value));
+}
+
+template <typename T, typename Compare, typename Allocator>
+void PersistentTree<T, Compare, Allocator>::Writer::drop(Node* node) {
+    // Ссылки на детей удаленного узла уже переданы другим узлам
+    if (node->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        tree.pool->destroy(node);
+    }
+}
+
+// Реализация методов PersistentTree
+
+template <typename T, typename Compare, typename Allocator>
+PersistentTree<T, Compare, Allocator>::PersistentTree(const Compare& comp, const Allocator& alloc)
+    : root(nullptr), treeSize(0), comp(comp), pool(std::make_shared<Pool>(alloc)), alloc(alloc) {}
+
+template <typename T, typename Compare, typename Allocator>
+template <typename InputIt>
+PersistentTree<T, Compare, Allocator>::PersistentTree(InputIt first, InputIt last, const Compare& comp,
+                                                      const Allocator& alloc)
+    : PersistentTree(comp, alloc) {
+    for (; first != last; ++first) {
+        insert(*first);
+    }
+}
+
+template <typename T, typename Compare, typename Allocator>
+PersistentTree<T, Compare, Allocator>::PersistentTree(std::initializer_list<T> init, const Compare& comp,
+                                                      const Allocator& alloc)
+    : PersistentTree(init.begin(), init.end(), comp, alloc) {}
+
+template <typename T, typename Compare, typename Allocator>
+PersistentTree<T, Compare, Allocator>::PersistentTree(const PersistentTree& other)
+    : root(retain(other.root)), treeSize(other.treeSize), comp(other.comp), pool(other.pool), alloc(other.alloc) {
+    // Узлы теперь могут освобождаться из потоков, владеющих другими версиями
+    if (pool) {
+        pool->markShared();
+    }
+}
+
+template <typename T, typename Compare, typename Allocator>
+PersistentTree<T, Compare, Allocator>::PersistentTree(PersistentTree&& other) noexcept
+    : root(std::exchange(other.root, nullptr)), treeSize(std::exchange(other.treeSize, 0)),
+      comp(std::move(other.comp)), pool(std::move(other.pool)), alloc(other.alloc) {
+    // Пул переходит целиком и не становится общим; перемещенному дереву
+    // новый пул создается при следующей записи
+}
+
+template <typename T, typename Compare, typename Allocator>
+PersistentTree<T, Compare, Allocator>::~PersistentTree() {
+    release(root);
+}
+
+template <typename T, typename Compare, typename Allocator>
+PersistentTree<T, Compare, Allocator>& PersistentTree<T, Compare, Allocator>::operator=(const PersistentTree& other) {
+    if (this != &other) {
+        PersistentTree copy(other);
+        swap(copy);
+    }
+    return *this;
+}
+
+template <typename T, typename Compare, typename Allocator>
+PersistentTree<T, Compare, Allocator>& PersistentTree<T, Compare, Allocator>::operator=(PersistentTree&& other) noexcept {
+    if (this != &other) {
+        release(root);
+        root = std::exchange(other.root, nullptr);
+        treeSize = std::exchange(other.treeSize, 0);
+        comp = std::move(other.comp);
+        pool = std::move(other.pool);
+        if constexpr (std::allocator_traits<Allocator>::propagate_on_container_move_assignment::value) {
+            alloc = other.alloc;
+        }
+    }
+    return *this;
+}
+
+template <typename T, typename Compare, typename Allocator>
+PersistentTree<T, Compare, Allocator> PersistentTree<T, Compare, Allocator>::snapshot() const {
+    return PersistentTree(*this);
+}
+
+template <typename T, typename Compare, typename Allocator>
+bool PersistentTree<T, Compare, Allocator>::insert(const T& value) {
+    return insertValue(value);
+}
+
+template <typename T, typename Compare, typename Allocator>
+bool PersistentTree<T, Compare, Allocator>::insert(T&& value) {
+    return insertValue(std::move(value));
+}
+
+template <typename T, typename Compare, typename Allocator>
+template <typename... Args>
+bool PersistentTree<T, Compare, Allocator>::emplace(Args&&... args) {
+    return insertValue(T(std::forward<Args>(args)...));
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename PersistentTree<T, Compare, Allocator>::size_type PersistentTree<T, Compare, Allocator>::erase(const T& value) {
+    if (Llrb::find(root, value, comp) == nullptr) {
+        return 0;
+    }
+    Writer writer(*this);
+    root = Llrb::erase(writer, root, value, comp);
+    treeSize--;
+    return 1;
+}
+
+template <typename T, typename Compare, typename Allocator>
+void PersistentTree<T, Compare, Allocator>::clear() {
+    release(root);
+    root = nullptr;
+    treeSize = 0;
+}
+
+template <typename T, typename Compare, typename Allocator>
+void PersistentTree<T, Compare, Allocator>::swap(PersistentTree& other) noexcept {
+    std::swap(root, other.root);
+    std::swap(treeSize, other.treeSize);
+    std::swap(comp, other.comp);
+    std::swap(pool, other.pool);
+    std::swap(alloc, other.alloc);
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename PersistentTree<T, Compare, Allocator>::iterator PersistentTree<T, Compare, Allocator>::find(const T& value) const {
+    iterator it = lower_bound(value);
+    return it != end() && !comp(value, *it) ? it : end();
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename PersistentTree<T, Compare, Allocator>::iterator PersistentTree<T, Compare, Allocator>::lower_bound(const T& value) const {
+    return boundPath([this, &value](const Node* node) { return !comp(node->val, value); });
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename PersistentTree<T, Compare, Allocator>::iterator PersistentTree<T, Compare, Allocator>::upper_bound(const T& value) const {
+    return boundPath([this, &value](const Node* node) { return comp(value, node->val); });
+}
+
+template <typename T, typename Compare, typename Allocator>
+std::pair<typename PersistentTree<T, Compare, Allocator>::iterator, typename PersistentTree<T, Compare, Allocator>::iterator>
+PersistentTree<T, Compare, Allocator>::equal_range(const T& value) const {
+    return {lower_bound(value), upper_bound(value)};
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename PersistentTree<T, Compare, Allocator>::size_type PersistentTree<T, Compare, Allocator>::count(const T& value) const {
+    return contains(value) ? 1 : 0;
+}
+
+template <typename T, typename Compare, typename Allocator>
+bool PersistentTree<T, Compare, Allocator>::contains(const T& value) const {
+    return Llrb::find(root, value, comp) != nullptr;
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename PersistentTree<T, Compare, Allocator>::iterator PersistentTree<T, Compare, Allocator>::begin() const {
+    return iterator::leftmost(root);
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename PersistentTree<T, Compare, Allocator>::iterator PersistentTree<T, Compare, Allocator>::end() const {
+    return iterator();
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename PersistentTree<T, Compare, Allocator>::iterator PersistentTree<T, Compare, Allocator>::cbegin() const {
+    return begin();
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename PersistentTree<T, Compare, Allocator>::iterator PersistentTree<T, Compare, Allocator>::cend() const {
+    return end();
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename PersistentTree<T, Compare, Allocator>::size_type PersistentTree<T, Compare, Allocator>::size() const {
+    return treeSize;
+}
+
+template <typename T, typename Compare, typename Allocator>
+bool PersistentTree<T, Compare, Allocator>::empty() const {
+    return root == nullptr;
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename PersistentTree<T, Compare, Allocator>::allocator_type PersistentTree<T, Compare, Allocator>::get_allocator() const {
+    return alloc;
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename PersistentTree<T, Compare, Allocator>::key_compare PersistentTree<T, Compare, Allocator>::key_comp() const {
+    return comp;
+}
+
+// Вспомогательные методы
+
+template <typename T, typename Compare, typename Allocator>
+typename PersistentTree<T, Compare, Allocator>::Node* PersistentTree<T, Compare, Allocator>::retain(Node* node) {
+    if (node != nullptr) {
+        node->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+    return node;
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename PersistentTree<T, Compare, Allocator>::Pool& PersistentTree<T, Compare, Allocator>::nodePool() {
+    if (!pool) {
+        pool = std::make_shared<Pool>(alloc);
+    }
+    return *pool;
+}
+
+template <typename T, typename Compare, typename Allocator>
+void PersistentTree<T, Compare, Allocator>::release(Node* node) {
+    // Последняя ссылка на узел освобождает и его ссылки на детей
+    std::vector<Node*> stack;
+    if (node != nullptr) {
+        stack.push_back(node);
+    }
+    while (!stack.empty()) {
+        Node* current = stack.back();
+        stack.pop_back();
+        if (current->refs.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+            continue;
+        }
+        if (current->left != nullptr) {
+            stack.push_back(current->left);
+        }
+        if (current->right != nullptr) {
+            stack.push_back(current->right);
+        }
+        pool->destroy(current);
+    }
+}
+
+template <typename T, typename Compare, typename Allocator>
+template <typename V>
+bool PersistentTree<T, Compare, Allocator>::insertValue(V&& value) {
+    if (Llrb::find(root, value, comp) != nullptr) {
+        return false;
+    }
+    Writer writer(*this);
+    root = Llrb::insert(writer, root, std::forward<V>(value), comp);
+    treeSize++;
+    return true;
+}
+
+template <typename T, typename Compare, typename Allocator>
+template <typename Path>
+typename PersistentTree<T, Compare, Allocator>::iterator
+PersistentTree<T, Compare, Allocator>::boundPath(Path goesLeft) const {
+    // В стеке остаются узлы, от которых спуск ушел влево: это следующие элементы
+    std::vector<const Node*> path;
+    for (const Node* node = root; node != nullptr;) {
+        if (goesLeft(node)) {
+            path.push_back(node);
+            node = node->left;
+        } else {
+            node = node->right;
+        }
+    }
+    return iterator(std::move(path));
+}
+
+#endif // PERSISTENT_TREE_HPP
@@ -0,0 +1,424 @@
+#ifndef SHARDED_TREE_HPP
+#define SHARDED_TREE_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "../tree/tree.hpp"
+
+// Предварительное объявление для итератора
+template <typename ShardedT>
+class ShardedIterator;
+
+// Дерево, разбитое на сегменты по диапазонам ключей.
+// Каждый сегмент - отдельное Tree со своей блокировкой и своим пулом узлов,
+// поэтому писатели в разные диапазоны не мешают друг другу. Сегмент i хранит
+// ключи из [bounds[i - 1], bounds[i]). Разросшийся сегмент (больше max_shard_size())
+// делится пополам по медиане; деление берет исключительную блокировку разметки.
+//
+// insert, erase, contains, count, size и for_each безопасны при одновременном вызове.
+// Итераторы (begin, find, lower_bound, ...) склеивают сегменты в общий порядок,
+// но блокировок не держат: ими пользуются, когда писатели не работают.
+template <typename T, typename Compare = std::less<T>, typename Allocator = std::allocator<T>>
+class ShardedTree {
+public:
+    // Типы
+    using iterator = ShardedIterator<ShardedTree>;
+    using const_iterator = iterator;
+    using value_type = T;
+    using key_type = T;
+    using size_type = size_t;
+    using key_compare = Compare;
+    using value_compare = Compare;
+    using allocator_type = Allocator;
+    using difference_type = std::ptrdiff_t;
+
+    // Порог деления по умолчанию для дерева, растущего из одного сегмента
+    static constexpr size_type DEFAULT_MAX_SHARD_SIZE = 1 << 16;
+
+    // Один сегмент, автоматическое деление с порогом DEFAULT_MAX_SHARD_SIZE
+    explicit ShardedTree(const Compare& comp = Compare(), const Allocator& alloc = Allocator());
+    // Заданные границы сегментов (должны возрастать), автоматическое деление выключено
+    explicit ShardedTree(std::vector<T> splitKeys, const Compare& comp = Compare(), const Allocator& alloc = Allocator());
+    // Границы по квантилям данных, shardCount сегментов равного размера
+    template <typename InputIt>
+    ShardedTree(InputIt first, InputIt last, size_type shardCount, const Compare& comp = Compare(),
+                const Allocator& alloc = Allocator());
+
+    ShardedTree(const ShardedTree&) = delete;
+    ShardedTree& operator=(const ShardedTree&) = delete;
+
+    // Потокобезопасные операции
+    bool insert(const T& value);
+    bool insert(T&& value);
+    template <typename... Args>
+    bool emplace(Args&&... args);
+    size_type erase(const T& value);
+    bool contains(const T& value) const;
+    size_type count(const T& value) const;
+    size_type size() const;
+    bool empty() const;
+
+    // Обход по возрастанию под разделяемыми блокировками сегментов
+    template <typename F>
+    void for_each(F f) const;
+    // Обход [lo, hi)
+    template <typename F>
+    void for_each(const T& lo, const T& hi, F f) const;
+
+    // Порог деления сегмента; 0 - без деления
+    void set_max_shard_size(size_type limit);
+    size_type max_shard_size() const;
+    size_type shard_count() const;
+
+    // Склеенный обход и поиск границ (без одновременной записи)
+    iterator begin() const;
+    iterator end() const;
+    iterator cbegin() const;
+    iterator cend() const;
+    iterator find(const T& value) const;
+    iterator lower_bound(const T& value) const;
+    iterator upper_bound(const T& value) const;
+    std::pair<iterator, iterator> equal_range(const T& value) const;
+
+    allocator_type get_allocator() const;
+    key_compare key_comp() const;
+
+private:
+    using ShardTree = Tree<T, Compare, Allocator>;
+    using ShardIterator = typename ShardTree::iterator;
+
+    struct Shard {
+        ShardTree tree;
+        mutable std::shared_mutex mutex;
+
+        explicit Shard(ShardTree&& t) : tree(std::move(t)) {}
+    };
+
+    std::vector<T> bounds;                        // нижние границы сегментов 1..n-1
+    std::vector<std::unique_ptr<Shard>> shards;   // адреса сегментов стабильны
+    mutable std::shared_mutex layoutMutex;        // разметка меняется только при делении
+    std::atomic<size_type> total;
+    std::atomic<size_type> maxShardSize;
+    Compare comp;
+    Allocator alloc;
+
+    size_type shardIndex(const T& value) const;
+    template <typename V>
+    bool insertValue(V&& value);
+    void splitShard(const Shard* target);
+
+    // Итератор внутри сегмента shard; end() сегмента переводится на следующий непустой
+    iterator makeIterator(size_type shard, ShardIterator it) const;
+    void skipForward(size_type& shard, ShardIterator& it) const;
+    void skipBackward(size_type& shard, ShardIterator& it) const;
+
+    // Дружественный класс для итератора
+    friend class ShardedIterator<ShardedTree>;
+};
+
+// Включаем реализацию итератора после определения ShardedTree
+#include "../iterator/sharded_iterator.hpp"
+
+// Реализация методов ShardedTree
+
+template <typename T, typename Compare, typename Allocator>
+ShardedTree<T, Compare, Allocator>::ShardedTree(const Compare& comp, const Allocator& alloc)
+    : total(0), maxShardSize(DEFAULT_MAX_SHARD_SIZE), comp(comp), alloc(alloc) {
+    shards.push_back(std::make_unique<Shard>(ShardTree(comp, alloc)));
+}
+
+template <typename T, typename Compare, typename Allocator>
+ShardedTree<T, Compare, Allocator>::ShardedTree(std::vector<T> splitKeys, const Compare& comp, const Allocator& alloc)
+    : bounds(std::move(splitKeys)), total(0), maxShardSize(0), comp(comp), alloc(alloc) {
+    for (size_type i = 1; i < bounds.size(); ++i) {
+        if (!comp(bounds[i - 1], bounds[i])) {
+            throw std::invalid_argument("ShardedTree: split keys must be strictly increasing");
+        }
+    }
+    for (size_type i = 0; i <= bounds.size(); ++i) {
+        shards.push_back(std::make_unique<Shard>(ShardTree(comp, alloc)));
+    }
+}
+
+template <typename T, typename Compare, typename Allocator>
+template <typename InputIt>
+ShardedTree<T, Compare, Allocator>::ShardedTree(InputIt first, InputIt last, size_type shardCount,
+                                                const Compare& comp, const Allocator& alloc)
+    : total(0), maxShardSize(0), comp(comp), alloc(alloc) {
+    std::vector<T> values(first, last);
+    std::sort(values.begin(), values.end(), comp);
+    values.erase(std::unique(values.begin(), values.end(),
+                             [&comp](const T& a, const T& b) { return !comp(a, b) && !comp(b, a); }),
+                 values.end());
+    shardCount = std::max<size_type>(1, std::min(shardCount, values.size()));
+    // Каждый сегмент строится за линейное время из своего отсортированного куска
+    size_type begin = 0;
+    for (size_type i = 0; i < shardCount; ++i) {
+        size_type end = values.size() * (i + 1) / shardCount;
+        if (i > 0) {
+            bounds.push_back(values[begin]);
+        }
+        shards.push_back(std::make_unique<Shard>(ShardTree(std::make_move_iterator(values.begin() + begin),
+                                                           std::make_move_iterator(values.begin() + end),
+                                                           comp, alloc)));
+        begin = end;
+    }
+    total = values.size();
+}
+
+template <typename T, typename Compare, typename Allocator>
+bool ShardedTree<T, Compare, Allocator>::insert(const T& value) {
+    return insertValue(value);
+}
+
+template <typename T, typename Compare, typename Allocator>
+bool ShardedTree<T, Compare, Allocator>::insert(T&& value) {
+    return insertValue(std::move(value));
+}
+
+template <typename T, typename Compare, typename Allocator>
+template <typename... Args>
+bool ShardedTree<T, Compare, Allocator>::emplace(Args&&... args) {
+    return insertValue(T(std::forward<Args>(args)...));
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename ShardedTree<T, Compare, Allocator>::size_type ShardedTree<T, Compare, Allocator>::erase(const T& value) {
+    std::shared_lock<std::shared_mutex> layout(layoutMutex);
+    Shard& shard = *shards[shardIndex(value)];
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    size_type erased = shard.tree.erase(value);
+    total.fetch_sub(erased, std::memory_order_relaxed);
+    return erased;
+}
+
+template <typename T, typename Compare, typename Allocator>
+bool ShardedTree<T, Compare, Allocator>::contains(const T& value) const {
+    std::shared_lock<std::shared_mutex> layout(layoutMutex);
+    const Shard& shard = *shards[shardIndex(value)];
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    return shard.tree.contains(value);
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename ShardedTree<T, Compare, Allocator>::size_type ShardedTree<T, Compare, Allocator>::count(const T& value) const {
+    return contains(value) ? 1 : 0;
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename ShardedTree<T, Compare, Allocator>::size_type ShardedTree<T, Compare, Allocator>::size() const {
+    return total.load(std::memory_order_relaxed);
+}
+
+template <typename T, typename Compare, typename Allocator>
+bool ShardedTree<T, Compare, Allocator>::empty() const {
+    return size() == 0;
+}
+
+template <typename T, typename Compare, typename Allocator>
+template <typename F>
+void ShardedTree<T, Compare, Allocator>::for_each(F f) const {
+    std::shared_lock<std::shared_mutex> layout(layoutMutex);
+    for (const auto& shard : shards) {
+        std::shared_lock<std::shared_mutex> lock(shard->mutex);
+        for (const T& value : shard->tree) {
+            f(value);
+        }
+    }
+}
+
+template <typename T, typename Compare, typename Allocator>
+template <typename F>
+void ShardedTree<T, Compare, Allocator>::for_each(const T& lo, const T& hi, F f) const {
+    if (!comp(lo, hi)) {
+        return;
+    }
+    std::shared_lock<std::shared_mutex> layout(layoutMutex);
+    size_type firstShard = shardIndex(lo);
+    size_type lastShard = shardIndex(hi);
+    for (size_type i = firstShard; i <= lastShard; ++i) {
+        const Shard& shard = *shards[i];
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        ShardIterator it = i == firstShard ? shard.tree.lower_bound(lo) : shard.tree.begin();
+        ShardIterator stop = i == lastShard ? shard.tree.lower_bound(hi) : shard.tree.end();
+        for (; it != stop; ++it) {
+            f(*it);
+        }
+    }
+}
+
+template <typename T, typename Compare, typename Allocator>
+void ShardedTree<T, Compare, Allocator>::set_max_shard_size(size_type limit) {
+    maxShardSize.store(limit, std::memory_order_relaxed);
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename ShardedTree<T, Compare, Allocator>::size_type ShardedTree<T, Compare, Allocator>::max_shard_size() const {
+    return maxShardSize.load(std::memory_order_relaxed);
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename ShardedTree<T, Compare, Allocator>::size_type ShardedTree<T, Compare, Allocator>::shard_count() const {
+    std::shared_lock<std::shared_mutex> layout(layoutMutex);
+    return shards.size();
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename ShardedTree<T, Compare, Allocator>::iterator ShardedTree<T, Compare, Allocator>::begin() const {
+    return makeIterator(0, shards[0]->tree.begin());
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename ShardedTree<T, Compare, Allocator>::iterator ShardedTree<T, Compare, Allocator>::end() const {
+    return iterator(this, shards.size(), ShardIterator());
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename ShardedTree<T, Compare, Allocator>::iterator ShardedTree<T, Compare, Allocator>::cbegin() const {
+    return begin();
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename ShardedTree<T, Compare, Allocator>::iterator ShardedTree<T, Compare, Allocator>::cend() const {
+    return end();
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename ShardedTree<T, Compare, Allocator>::iterator ShardedTree<T, Compare, Allocator>::find(const T& value) const {
+    size_type shard = shardIndex(value);
+    ShardIterator it = shards[shard]->tree.lower_bound(value);
+    if (it == shards[shard]->tree.end() || comp(value, *it)) {
+        return end();
+    }
+    return iterator(this, shard, it);
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename ShardedTree<T, Compare, Allocator>::iterator ShardedTree<T, Compare, Allocator>::lower_bound(const T& value) const {
+    size_type shard = shardIndex(value);
+    return makeIterator(shard, shards[shard]->tree.lower_bound(value));
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename ShardedTree<T, Compare, Allocator>::iterator ShardedTree<T, Compare, Allocator>::upper_bound(const T& value) const {
+    size_type shard = shardIndex(value);
+    return makeIterator(shard, shards[shard]->tree.upper_bound(value));
+}
+
+template <typename T, typename Compare, typename Allocator>
+std::pair<typename ShardedTree<T, Compare, Allocator>::iterator, typename ShardedTree<T, Compare, Allocator>::iterator>
+ShardedTree<T, Compare, Allocator>::equal_range(const T& value) const {
+    return {lower_bound(value), upper_bound(value)};
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename ShardedTree<T, Compare, Allocator>::allocator_type ShardedTree<T, Compare, Allocator>::get_allocator() const {
+    return alloc;
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename ShardedTree<T, Compare, Allocator>::key_compare ShardedTree<T, Compare, Allocator>::key_comp() const {
+    return comp;
+}
+
+// Вспомогательные методы
+
+template <typename T, typename Compare, typename Allocator>
+typename ShardedTree<T, Compare, Allocator>::size_type ShardedTree<T, Compare, Allocator>::shardIndex(const T& value) const {
+    return static_cast<size_type>(std::upper_bound(bounds.begin(), bounds.end(), value, comp) - bounds.begin());
+}
+
+template <typename T, typename Compare, typename Allocator>
+template <typename V>
+bool ShardedTree<T, Compare, Allocator>::insertValue(V&& value) {
+    bool inserted;
+    const Shard* oversized = nullptr;
+    {
+        std::shared_lock<std::shared_mutex> layout(layoutMutex);
+        Shard& shard = *shards[shardIndex(value)];
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        inserted = shard.tree.insert(std::forward<V>(value)).second;
+        size_type limit = maxShardSize.load(std::memory_order_relaxed);
+        if (limit != 0 && shard.tree.size() > limit) {
+            oversized = &shard;
+        }
+    }
+    if (inserted) {
+        total.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (oversized != nullptr) {
+        splitShard(oversized);
+    }
+    return inserted;
+}
+
+template <typename T, typename Compare, typename Allocator>
+void ShardedTree<T, Compare, Allocator>::splitShard(const Shard* target) {
+    std::unique_lock<std::shared_mutex> layout(layoutMutex);
+    // Пока блокировка ожидалась, другой писатель мог уже разделить сегмент и сдвинуть номера
+    size_type index = 0;
+    while (index < shards.size() && shards[index].get() != target) {
+        ++index;
+    }
+    size_type limit = maxShardSize.load(std::memory_order_relaxed);
+    if (index == shards.size() || limit == 0 || shards[index]->tree.size() <= limit) {
+        return;
+    }
+    // Половины перестраиваются за O(n) в новые деревья со своими пулами
+    // (Tree::split оставил бы один пул на оба сегмента). Значения копируются:
+    // если построение бросит исключение, опубликованный сегмент останется целым
+    ShardTree& tree = shards[index]->tree;
+    ShardIterator middle = std::next(tree.begin(), static_cast<difference_type>(tree.size() / 2));
+    T median = *middle;
+    ShardTree right(middle, tree.end(), comp, alloc);
+    ShardTree left(tree.begin(), middle, comp, alloc);
+    auto shard = std::make_unique<Shard>(std::move(right));
+    bounds.reserve(bounds.size() + 1);
+    shards.reserve(shards.size() + 1);
+    bounds.insert(bounds.begin() + static_cast<difference_type>(index), std::move(median));
+    shards.insert(shards.begin() + static_cast<difference_type>(index) + 1, std::move(shard));
+    // Старое дерево заменяется только после того, как обе половины построены
+    tree = std::move(left);
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename ShardedTree<T, Compare, Allocator>::iterator
+ShardedTree<T, Compare, Allocator>::makeIterator(size_type shard, ShardIterator it) const {
+    skipForward(shard, it);
+    return iterator(this, shard, it);
+}
+
+template <typename T, typename Compare, typename Allocator>
+void ShardedTree<T, Compare, Allocator>::skipForward(size_type& shard, ShardIterator& it) const {
+    while (shard < shards.size() && it == shards[shard]->tree.end()) {
+        ++shard;
+        it = shard < shards.size() ? shards[shard]->tree.begin() : ShardIterator();
+    }
+}
+
+template <typename T, typename Compare, typename Allocator>
+void ShardedTree<T, Compare, Allocator>::skipBackward(size_type& shard, ShardIterator& it) const {
+    // С end() переходим к максимальному элементу последнего непустого сегмента
+    while (true) {
+        if (shard < shards.size() && it != shards[shard]->tree.begin()) {
+            --it;
+            return;
+        }
+        if (shard == 0) {
+            return;
+        }
+        --shard;
+        it = shards[shard]->tree.end();
+    }
+}
+
+#endif // SHARDED_TREE_HPP
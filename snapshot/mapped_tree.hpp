@@ -0,0 +1,94 @@
+#ifndef MAPPED_TREE_HPP
+#define MAPPED_TREE_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <utility>
+#include "snapshot_file.hpp"
+
+// Дерево только для чтения прямо из отображенного в память снимка (ConstructorsUtil::openMapped).
+// Элементы не разбираются и не копируются: поиск - двоичный по отсортированному
+// массиву в отображении, итераторы - указатели на элементы в нем.
+// Отображение живет, пока жива хотя бы одна копия MappedTree.
+template <typename T, typename Compare = std::less<T>>
+class MappedTree {
+public:
+    // Типы
+    using iterator = const T*;
+    using const_iterator = iterator;
+    using value_type = T;
+    using key_type = T;
+    using size_type = size_t;
+    using key_compare = Compare;
+    using value_compare = Compare;
+    using difference_type = std::ptrdiff_t;
+
+    MappedTree(std::shared_ptr<const snapshot_detail::MappedFile> file, const T* first, size_type count,
+               const Compare& comp = Compare())
+        : file(std::move(file)), first(first), valueCount(count), comp(comp) {}
+
+    // Поиск за O(log n)
+    iterator find(const T& value) const {
+        iterator it = lower_bound(value);
+        return it != end() && !comp(value, *it) ? it : end();
+    }
+
+    iterator lower_bound(const T& value) const {
+        return std::lower_bound(begin(), end(), value, comp);
+    }
+
+    iterator upper_bound(const T& value) const {
+        return std::upper_bound(begin(), end(), value, comp);
+    }
+
+    std::pair<iterator, iterator> equal_range(const T& value) const {
+        return std::equal_range(begin(), end(), value, comp);
+    }
+
+    size_type count(const T& value) const {
+        return contains(value) ? 1 : 0;
+    }
+
+    bool contains(const T& value) const {
+        return find(value) != end();
+    }
+
+    // Обход в порядке возрастания
+    iterator begin() const {
+        return first;
+    }
+
+    iterator end() const {
+        return first + valueCount;
+    }
+
+    iterator cbegin() const {
+        return begin();
+    }
+
+    iterator cend() const {
+        return end();
+    }
+
+    size_type size() const {
+        return valueCount;
+    }
+
+    bool empty() const {
+        return valueCount == 0;
+    }
+
+    key_compare key_comp() const {
+        return comp;
+    }
+
+private:
+    std::shared_ptr<const snapshot_detail::MappedFile> file;
+    const T* first;
+    size_type valueCount;
+    Compare comp;
+};
+
+#endif // MAPPED_TREE_HPP
@@ -0,0 +1,230 @@
+#ifndef SNAPSHOT_FILE_HPP
+#define SNAPSHOT_FILE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <typeinfo>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define SNAPSHOT_HAS_MMAP 1
+#endif
+
+namespace snapshot_detail {
+
+// Бинарный снимок дерева: заголовок на 64 байта и элементы в порядке компаратора дерева,
+// побайтовые копии T. Данные начинаются с границы 64 байт, поэтому отображенный
+// в память файл читается как массив T без разбора.
+struct SnapshotHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t valueSize;
+    std::uint32_t valueAlign;
+    std::uint32_t byteOrder;  // BYTE_ORDER_TAG в порядке байт записавшей машины
+    std::uint64_t count;
+    std::uint64_t checksum;   // по байтам элементов
+    std::uint64_t comparator; // comparatorTag<T, Compare>() записавшего дерева
+    unsigned char reserved[16];
+};
+
+static_assert(sizeof(SnapshotHeader) == 64, "Snapshot header must be 64 bytes");
+
+constexpr char MAGIC[8] = {'R', 'B', 'T', 'S', 'N', 'A', 'P', '\0'};
+constexpr std::uint32_t FORMAT_VERSION = 2;  // версия 1 не хранила компаратор и писалась с std::less
+constexpr std::uint32_t BYTE_ORDER_TAG = 0x01020304;
+constexpr std::uint64_t CHECKSUM_SEED = 0xcbf29ce484222325ULL;
+constexpr std::size_t CHUNK_VALUES = 8192;
+
+// FNV-1a по 8-байтовым словам (хвост - по байтам). Каждый шаг обратим, поэтому
+// любое изменение одного слова меняет сумму. Куски, кроме последнего, кратны 8 байтам
+inline std::uint64_t checksum(std::uint64_t hash, const unsigned char* bytes, std::size_t length) {
+    constexpr std::uint64_t prime = 0x100000001b3ULL;
+    std::size_t i = 0;
+    for (; i + 8 <= length; i += 8) {
+        std::uint64_t word;
+        std::memcpy(&word, bytes + i, sizeof(word));
+        hash = (hash ^ word) * prime;
+    }
+    for (; i < length; ++i) {
+        hash = (hash ^ bytes[i]) * prime;
+    }
+    return hash;
+}
+
+// Метка порядка элементов: стандартные компараторы узнаются по типу, остальные -
+// по имени типа (оно зависит от компилятора, поэтому такой снимок открывается
+// только программой, собранной тем же компилятором)
+template <typename T, typename Compare>
+std::uint64_t comparatorTag() {
+    if constexpr (std::is_same<Compare, std::less<T>>::value || std::is_same<Compare, std::less<>>::value) {
+        return 1;
+    } else if constexpr (std::is_same<Compare, std::greater<T>>::value || std::is_same<Compare, std::greater<>>::value) {
+        return 2;
+    } else {
+        const char* name = typeid(Compare).name();
+        return checksum(CHECKSUM_SEED, reinterpret_cast<const unsigned char*>(name), std::strlen(name)) | 0x8000000000000000ULL;
+    }
+}
+
+// Запись снимка из отсортированной по Compare последовательности count элементов
+template <typename T, typename Compare, typename It>
+void writeSnapshot(const std::string& filename, It first, std::size_t count) {
+    static_assert(std::is_trivially_copyable<T>::value, "Binary snapshots require trivially copyable T");
+    static_assert(alignof(T) <= sizeof(SnapshotHeader), "Value alignment exceeds the snapshot header size");
+
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        throw std::runtime_error("Cannot open file: " + filename);
+    }
+
+    SnapshotHeader header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = FORMAT_VERSION;
+    header.valueSize = static_cast<std::uint32_t>(sizeof(T));
+    header.valueAlign = static_cast<std::uint32_t>(alignof(T));
+    header.byteOrder = BYTE_ORDER_TAG;
+    header.count = count;
+    header.checksum = CHECKSUM_SEED;
+    header.comparator = comparatorTag<T, Compare>();
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    // Элементы копируются кусками; заголовок с итоговой суммой дописывается в конце
+    std::vector<T> chunk;
+    chunk.reserve(CHUNK_VALUES);
+    std::size_t written = 0;
+    while (written < count) {
+        chunk.clear();
+        for (; chunk.size() < CHUNK_VALUES && written < count; ++written, ++first) {
+            chunk.push_back(*first);
+        }
+        const auto* bytes = reinterpret_cast<const unsigned char*>(chunk.data());
+        std::size_t length = chunk.size() * sizeof(T);
+        header.checksum = checksum(header.checksum, bytes, length);
+        file.write(reinterpret_cast<const char*>(bytes), static_cast<std::streamsize>(length));
+    }
+
+    file.seekp(0);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.flush();
+    if (!file) {
+        throw std::runtime_error("Cannot write snapshot: " + filename);
+    }
+}
+
+// Файл, отображенный в память только для чтения (без mmap - прочитанный в буфер)
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& filename) : bytes(nullptr), length(0) {
+#ifdef SNAPSHOT_HAS_MMAP
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("Cannot open file: " + filename);
+        }
+        struct stat info;
+        if (::fstat(fd, &info) != 0) {
+            ::close(fd);
+            throw std::runtime_error("Cannot stat file: " + filename);
+        }
+        length = static_cast<std::size_t>(info.st_size);
+        if (length != 0) {
+            void* mapping = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping == MAP_FAILED) {
+                ::close(fd);
+                throw std::runtime_error("Cannot map file: " + filename);
+            }
+            bytes = static_cast<const unsigned char*>(mapping);
+        }
+        ::close(fd);
+#else
+        std::ifstream file(filename, std::ios::binary | std::ios::ate);
+        if (!file.is_open()) {
+            throw std::runtime_error("Cannot open file: " + filename);
+        }
+        length = static_cast<std::size_t>(file.tellg());
+        buffer.resize((length + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t));
+        file.seekg(0);
+        file.read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(length));
+        if (!file) {
+            throw std::runtime_error("Cannot read file: " + filename);
+        }
+        bytes = reinterpret_cast<const unsigned char*>(buffer.data());
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile() {
+#ifdef SNAPSHOT_HAS_MMAP
+        if (bytes != nullptr) {
+            ::munmap(const_cast<unsigned char*>(bytes), length);
+        }
+#endif
+    }
+
+    const unsigned char* data() const {
+        return bytes;
+    }
+
+    std::size_t size() const {
+        return length;
+    }
+
+private:
+    const unsigned char* bytes;
+    std::size_t length;
+#ifndef SNAPSHOT_HAS_MMAP
+    std::vector<std::uint64_t> buffer;
+#endif
+};
+
+// Проверка заголовка и (по желанию) контрольной суммы; возвращает начало элементов.
+// Снимок, упорядоченный другим компаратором, отвергается: поиск по нему дал бы неверный ответ
+template <typename T, typename Compare>
+const T* validateSnapshot(const MappedFile& file, const std::string& filename, std::size_t& count, bool verify) {
+    static_assert(std::is_trivially_copyable<T>::value, "Binary snapshots require trivially copyable T");
+
+    if (file.size() < sizeof(SnapshotHeader)) {
+        throw std::runtime_error("Snapshot is truncated: " + filename);
+    }
+    SnapshotHeader header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+        throw std::runtime_error("Not a tree snapshot: " + filename);
+    }
+    if (header.version == 1) {
+        header.comparator = comparatorTag<T, std::less<T>>();
+    } else if (header.version != FORMAT_VERSION) {
+        throw std::runtime_error("Unsupported snapshot version: " + filename);
+    }
+    if (header.comparator != comparatorTag<T, Compare>()) {
+        throw std::runtime_error("Snapshot was written with a different comparator: " + filename);
+    }
+    if (header.byteOrder != BYTE_ORDER_TAG || header.valueSize != sizeof(T) || header.valueAlign != alignof(T)) {
+        throw std::runtime_error("Snapshot was written for a different value layout: " + filename);
+    }
+    std::size_t payload = file.size() - sizeof(SnapshotHeader);
+    if (header.count > payload / sizeof(T) || header.count * sizeof(T) != payload) {
+        throw std::runtime_error("Snapshot size does not match its header: " + filename);
+    }
+    const unsigned char* values = file.data() + sizeof(SnapshotHeader);
+    if (verify && checksum(CHECKSUM_SEED, values, payload) != header.checksum) {
+        throw std::runtime_error("Snapshot checksum mismatch: " + filename);
+    }
+    count = static_cast<std::size_t>(header.count);
+    return reinterpret_cast<const T*>(values);
+}
+
+} // namespace snapshot_detail
+
+#endif // SNAPSHOT_FILE_HPP
@@ -0,0 +1,73 @@
+#ifndef KEY_COMPARE_HPP
+#define KEY_COMPARE_HPP
+
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+#if __cplusplus > 201703L && defined(__cpp_impl_three_way_comparison) && __has_include(<compare>)
+#include <compare>
+#define TREE_HAS_SPACESHIP 1
+#endif
+
+namespace tree_detail {
+
+// Компаратор по умолчанию, для которого порядок совпадает с "естественным"
+template <typename Compare, typename T>
+struct IsNaturalOrder
+    : std::integral_constant<bool, std::is_same<Compare, std::less<T>>::value ||
+                                   std::is_same<Compare, std::less<>>::value> {};
+
+// a.compare(b) в стиле std::string: отрицательное, ноль или положительное
+template <typename A, typename B, typename = void>
+struct HasCompareMember : std::false_type {};
+
+template <typename A, typename B>
+struct HasCompareMember<A, B, std::void_t<decltype(std::declval<const A&>().compare(std::declval<const B&>()))>>
+    : std::is_convertible<decltype(std::declval<const A&>().compare(std::declval<const B&>())), int> {};
+
+#ifdef TREE_HAS_SPACESHIP
+template <typename A, typename B, typename = void>
+struct HasSpaceship : std::false_type {};
+
+template <typename A, typename B>
+struct HasSpaceship<A, B, std::void_t<decltype(std::declval<const A&>() <=> std::declval<const B&>())>>
+    : std::true_type {};
+#endif
+
+// Можно ли сравнить a и b одной трехсторонней операцией вместо двух вызовов Compare
+template <typename Compare, typename T, typename A, typename B>
+constexpr bool hasThreeWay() {
+    if constexpr (!IsNaturalOrder<Compare, T>::value) {
+        return false;
+    } else if constexpr (HasCompareMember<A, B>::value) {
+        return true;
+    } else {
+#ifdef TREE_HAS_SPACESHIP
+        return !std::is_arithmetic<A>::value && HasSpaceship<A, B>::value;
+#else
+        return false;
+#endif
+    }
+}
+
+// Трехстороннее сравнение: <0, если a < b; 0, если эквивалентны; >0, если a > b
+template <typename Compare, typename T, typename A, typename B>
+int threeWay(const Compare& comp, const A& a, const B& b) {
+    if constexpr (hasThreeWay<Compare, T, A, B>()) {
+        if constexpr (HasCompareMember<A, B>::value) {
+            return a.compare(b);
+        } else {
+#ifdef TREE_HAS_SPACESHIP
+            auto c = a <=> b;
+            return c < 0 ? -1 : (c > 0 ? 1 : 0);
+#endif
+        }
+    } else {
+        return comp(a, b) ? -1 : (comp(b, a) ? 1 : 0);
+    }
+}
+
+} // namespace tree_detail
+
+#endif // KEY_COMPARE_HPP
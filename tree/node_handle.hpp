@@ -0,0 +1,97 @@
+#ifndef NODE_HANDLE_HPP
+#define NODE_HANDLE_HPP
+
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+// Дескриптор извлеченного узла (Tree::extract): узел вынут из дерева, но не уничтожен
+// и может быть вставлен в другое дерево без выделения памяти и копирования значения.
+// Держит пул, из которого выдан узел; если дескриптор уничтожается непустым,
+// узел возвращается в этот пул. Уничтожать его одновременно с изменением исходного
+// дерева из другого потока нельзя.
+// TreeT - конкретная специализация Tree (определена в tree.hpp)
+template <typename TreeT>
+class TreeNodeHandle {
+public:
+    using value_type = typename TreeT::value_type;
+    using allocator_type = typename TreeT::allocator_type;
+
+private:
+    using Node = typename TreeT::Node;
+    using Pool = typename TreeT::Pool;
+    Node* node;
+    std::shared_ptr<Pool> pool;
+
+    TreeNodeHandle(Node* n, std::shared_ptr<Pool> p) : node(n), pool(std::move(p)) {}
+
+    // Узел переходит к дереву вместе с ответственностью за него
+    Node* release() {
+        Node* n = node;
+        node = nullptr;
+        pool.reset();
+        return n;
+    }
+
+    void reset() {
+        if (node != nullptr) {
+            node->val.~value_type();
+            pool->destroy(node);
+            node = nullptr;
+        }
+        pool.reset();
+    }
+
+    friend TreeT;
+
+public:
+    TreeNodeHandle() : node(nullptr) {}
+
+    TreeNodeHandle(TreeNodeHandle&& other) noexcept : node(other.node), pool(std::move(other.pool)) {
+        other.node = nullptr;
+    }
+
+    TreeNodeHandle& operator=(TreeNodeHandle&& other) noexcept {
+        if (this != &other) {
+            reset();
+            node = other.node;
+            pool = std::move(other.pool);
+            other.node = nullptr;
+        }
+        return *this;
+    }
+
+    TreeNodeHandle(const TreeNodeHandle&) = delete;
+    TreeNodeHandle& operator=(const TreeNodeHandle&) = delete;
+
+    ~TreeNodeHandle() {
+        reset();
+    }
+
+    bool empty() const {
+        return node == nullptr;
+    }
+
+    explicit operator bool() const {
+        return node != nullptr;
+    }
+
+    // Значение можно менять, пока узел вне дерева (например, ключ перед вставкой)
+    value_type& value() const {
+        if (node == nullptr) {
+            throw std::runtime_error("Accessing value of an empty node handle");
+        }
+        return node->val;
+    }
+
+    allocator_type get_allocator() const {
+        return allocator_type(pool->get_allocator());
+    }
+
+    void swap(TreeNodeHandle& other) noexcept {
+        std::swap(node, other.node);
+        pool.swap(other.pool);
+    }
+};
+
+#endif // NODE_HANDLE_HPP
@@ -0,0 +1,28 @@
+#ifndef NODE_LINKS_HPP
+#define NODE_LINKS_HPP
+
+// Раскладка связей узла Tree.
+// NodeLinks<Node> примешивается к узлу; threaded означает, что узлы дополнительно
+// связаны в двусвязный список в порядке ключей и итератор ходит по нему.
+
+// Только связи дерева: итератор ищет соседа подъемом и спуском
+struct PlainLinks {
+    static constexpr bool threaded = false;
+
+    template <typename Node>
+    struct NodeLinks {};
+};
+
+// Прошитое дерево: prev/next к соседям по порядку, ++ и -- - одно чтение указателя.
+// Стоит двух указателей на узел и их поддержки при вставке и удалении
+struct ThreadedLinks {
+    static constexpr bool threaded = true;
+
+    template <typename Node>
+    struct NodeLinks {
+        Node* prev = nullptr;
+        Node* next = nullptr;
+    };
+};
+
+#endif // NODE_LINKS_HPP
@@ -6,21 +6,66 @@
 #include <algorithm>
 #include <stdexcept>
 #include <iterator>
+#include <memory>
+#include <type_traits>
+#include <vector>
+#include <functional>
+#include <mutex>
+#include "key_compare.hpp"
+#include "prefetch.hpp"
+#include "node_links.hpp"
+#include "../node_pool/node_pool.hpp"
+#include "../frozen/frozen_tree.hpp"
+#include "../augment/augment.hpp"
+#include "../parallel/thread_pool.hpp"
 
 // Предварительное объявление для итератора
-template <typename T>
+template <typename TreeT>
 class TreeIterator;
 
+// Дескриптор извлеченного узла (node_handle.hpp)
+template <typename TreeT>
+class TreeNodeHandle;
+
+// Словарь поверх Tree (map/tree_map.hpp)
+template <typename K, typename V, typename Compare, typename Allocator>
+class TreeMap;
+
+// Построение из файлов (constructor_utils/constructor_utils.hpp)
 template <typename T>
+class ConstructorsUtil;
+
+// Compare с is_transparent разрешает поиск по ключам другого типа (например, string_view)
+// Augment - политика дополнения узлов (см. augment/augment.hpp)
+// Links - раскладка связей узла: PlainLinks или ThreadedLinks (см. node_links.hpp)
+template <typename T, typename Compare = std::less<T>, typename Allocator = std::allocator<T>,
+          typename Augment = NoAugment, typename Links = PlainLinks>
 class Tree {
 public:
     // Типы
-    using iterator = TreeIterator<T>;
+    using iterator = TreeIterator<Tree>;
     using value_type = T;
+    using key_type = T;
     using size_type = size_t;
+    using key_compare = Compare;
+    using value_compare = Compare;
+    using allocator_type = Allocator;
+    using difference_type = std::ptrdiff_t;
+    using node_type = TreeNodeHandle<Tree>;
+
+    // Результат вставки узла: при отказе узел возвращается в node
+    struct insert_return_type {
+        iterator position;
+        bool inserted;
+        node_type node;
+    };
 
     // Конструкторы и деструктор
     Tree();
+    explicit Tree(const Compare& comp, const Allocator& alloc = Allocator());
+    explicit Tree(const Allocator& alloc);
+    template <typename InputIt>
+    Tree(InputIt first, InputIt last, const Compare& comp = Compare(), const Allocator& alloc = Allocator());
     Tree(const Tree& other);
     Tree(Tree&& other) noexcept;
     ~Tree();
@@ -29,10 +74,73 @@ public:
     Tree& operator=(const Tree& other);
     Tree& operator=(Tree&& other) noexcept;
 
+    // Построение за O(n) из диапазона (несортированный вход сортируется)
+    template <typename InputIt>
+    void assign_sorted(InputIt first, InputIt last);
+
     // Основные операции
     std::pair<iterator, bool> insert(const T& value);
+    std::pair<iterator, bool> insert(T&& value);
+    template <typename... Args>
+    std::pair<iterator, bool> emplace(Args&&... args);
     size_type erase(const T& value);
+    // Удаление по итератору без повторного спуска; возвращает следующий элемент
+    iterator erase(iterator position);
     iterator find(const T& value);
+
+    // Вставка с подсказкой: если hint указывает на соседа нового значения,
+    // узел привязывается рядом с ним без спуска от корня
+    iterator insert(iterator hint, const T& value);
+    iterator insert(iterator hint, T&& value);
+
+    // Перенос узлов между деревьями без выделения памяти и копирования значений.
+    // Узлы переходят напрямую, если пулы деревьев удается объединить (как в join);
+    // иначе значение перемещается в новый узел своего пула
+    node_type extract(iterator position);
+    node_type extract(const T& value);
+    insert_return_type insert(node_type&& node);
+    // Переносит из source узлы с ключами, которых здесь нет; остальные остаются в source
+    void merge(Tree& source);
+
+    // Пакетные операции: пакет сортируется, очищается от повторов и применяется
+    // объединением или разностью деревьев за O(m log(n/m + 1)), перестраиваются только затронутые поддеревья
+    template <typename InputIt>
+    void insert_range(InputIt first, InputIt last);
+    template <typename InputIt>
+    void erase_range(InputIt first, InputIt last);
+
+    // Гетерогенный поиск (только для прозрачных компараторов)
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    size_type erase(const K& key);
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    iterator find(const K& key);
+
+    // Поиск границ за O(log n) спуском по дереву
+    iterator lower_bound(const T& value) const;
+    iterator upper_bound(const T& value) const;
+    std::pair<iterator, iterator> equal_range(const T& value) const;
+    size_type count(const T& value) const;
+    bool contains(const T& value) const;
+
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    iterator lower_bound(const K& key) const;
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    iterator upper_bound(const K& key) const;
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    std::pair<iterator, iterator> equal_range(const K& key) const;
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    size_type count(const K& key) const;
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    bool contains(const K& key) const;
+
+    // Пакетный поиск: спуски для группы ключей идут вперемешку, пока один ждет память,
+    // другие работают. В out пишутся итераторы (end(), если ключа нет) или флаги наличия
+    // в порядке ключей. ForwardIt - многопроходный итератор по ключам
+    template <typename ForwardIt, typename OutputIt>
+    OutputIt find_many(ForwardIt first, ForwardIt last, OutputIt out);
+    template <typename ForwardIt, typename OutputIt>
+    OutputIt contains_many(ForwardIt first, ForwardIt last, OutputIt out) const;
+
     iterator begin();
     iterator end();
     iterator begin() const;
@@ -40,104 +148,271 @@ public:
     iterator cbegin() const;
     iterator cend() const;
 
+    // Порядковые статистики (только с Augment = OrderStatistics), O(log n)
+    iterator nth(size_type k) const;
+    size_type rank(const T& value) const;
+    size_type count_range(const T& lo, const T& hi) const;
+    difference_type distance(iterator first, iterator last) const;
+
+    // Свертка моноида по отрезку [lo, hi] (только с Augment = MonoidAugment), O(log n)
+    template <typename A = Augment>
+    typename A::aggregate_type aggregate(const T& lo, const T& hi) const;
+
+    // Разделение и слияние деревьев (join-based алгоритмы)
+    // split оставляет элементы < key и возвращает дерево с элементами >= key. Без порядковых
+    // статистик размеры частей досчитываются обходом меньшей из них: O(log n + min(k, n - k))
+    Tree split(const T& key);
+    void join(Tree& other);    // переносит other в конец дерева; все ключи other должны быть больше
+
+    // Операции над множествами за O(m log(n/m + 1)), поддеревья обрабатываются параллельно
+    void union_with(const Tree& other);
+    void intersect_with(const Tree& other);
+    void difference_with(const Tree& other);
+
     // Информация о дереве
     size_type size() const;
     bool empty() const;
     void clear();
+    // Очистка в фоне: дерево сразу пусто, узлы уничтожаются в общем пуле потоков
+    // (без рабочих потоков - здесь же). Не вызывать из деструкторов статических объектов
+    void clear_async();
+    allocator_type get_allocator() const;
+    key_compare key_comp() const;
+
+    // Неизменяемый снимок для частых запросов, O(n)
+    FrozenTree<T, Compare, Allocator> freeze() const;
 
 private:
     // Узел дерева
-    struct Node {
-        T val;
+    // Значение хранится в union: у sentinel-узла оно не конструируется,
+    // у остальных создается на месте и разрушается в destroyNode
+    struct Node : Augment::NodeData, Links::template NodeLinks<Node> {
+        union {
+            T val;
+        };
         Node* left;
         Node* right;
         Node* parent;
         enum Color { RED, BLACK } color;
 
-        Node(const T& k) : val(k), left(nullptr), right(nullptr), parent(nullptr), color(RED) {}
+        // Sentinel: черный, ссылается сам на себя
+        Node() : left(this), right(this), parent(this), color(BLACK) {}
+
+        template <typename... Args>
+        explicit Node(std::in_place_t, Args&&... args)
+            : val(std::forward<Args>(args)...), left(nullptr), right(nullptr), parent(nullptr), color(RED) {}
+
+        ~Node() {}
     };
 
+    using Pool = NodePool<Node, Allocator>;
+
     Node* root;
-    Node* nil;  // Sentinel node
+    Node* nil;  // Sentinel node, общий для всех деревьев этого типа и только для чтения
+    Node* leftmost;   // Минимальный и максимальный узлы (nil у пустого дерева): begin() и --end() за O(1)
+    Node* rightmost;
     size_type treeSize;
+    Compare comp;
+    std::shared_ptr<Pool> pool;  // Память под узлы; после split/join пул общий для нескольких деревьев
+    Allocator alloc;  // Аллокатор пользователя: из него пересоздается пул после перемещения или clear_async
+
+    static Node* sentinel();
 
-    // Вращения
+    // Вращения (top - корень поддерева, в котором идет балансировка)
     void rotateLeft(Node* x);
     void rotateRight(Node* x);
+    void rotateLeft(Node* x, Node*& top);
+    void rotateRight(Node* x, Node*& top);
 
     // Балансировка
     void fixInsert(Node* z);
-    void fixDelete(Node* x);
+    bool fixInsert(Node* z, Node*& top);  // true, если черная высота top выросла
+    void fixDelete(Node* x, Node* xParent);
+
+    // Дополнительные данные узла (размер поддерева, свертка моноида)
+    void updateAugment(Node* node);
+    void updatePath(Node* node);
+    size_type nodeRank(Node* node) const;
+
+    // Создание и уничтожение узлов
+    template <typename... Args>
+    Node* createNode(Args&&... args);
+    void destroyNode(Node* node);
+    Pool& nodePool();
+    bool sharePoolWith(Tree& other);
+    bool sharePool(std::shared_ptr<Pool>& otherPool);
+    Node* adoptNode(node_type& handle);
+    void adjustSize(size_type added, size_type removed);
+
+    // Вставка: поиск места и привязка нового узла
+    template <typename V>
+    std::pair<iterator, bool> insertValue(V&& value);
+    template <typename V>
+    iterator insertHint(Node* hint, V&& value);
+    template <typename K>
+    Node* findInsertParent(const K& key, Node*& parent, bool& asLeft) const;
+    // Поиск места по ключу; узел конструируется из args, только если ключа нет
+    template <typename K, typename... Args>
+    std::pair<iterator, bool> emplaceKey(const K& key, Args&&... args);
+    void linkNode(Node* z, Node* parent, bool asLeft);
+    void eraseNode(Node* z);
+    // Исключение узла из дерева без уничтожения
+    void unlinkNode(Node* z);
 
     // Вспомогательные методы
-    Node* search(Node* node, const T& value) const;
+    template <typename K>
+    Node* search(Node* node, const K& key) const;
+    template <typename K>
+    Node* lowerBound(const K& key) const;
+    template <typename K>
+    Node* upperBound(const K& key) const;
+    template <typename K>
+    std::pair<iterator, iterator> equalRange(const K& key) const;
+    template <typename ForwardIt, typename Emit>
+    void searchMany(ForwardIt first, ForwardIt last, Emit emit) const;
     Node* minimum(Node* node) const;
     Node* maximum(Node* node) const;
     void transplant(Node* u, Node* v);
     Node* successor(Node* node) const;
     Node* predecessor(Node* node) const;
 
-    // Рекурсивные методы
-    void clearRecursive(Node* node);
-    Node* copyRecursive(Node* node, Node* parent);
+    // Соседи по порядку: через prev/next у прошитого дерева, иначе через связи дерева
+    Node* nextNode(Node* node) const;
+    Node* prevNode(Node* node) const;
+    void unthread(Node* node);
+    void threadNodes(const std::vector<Node*>& added, std::vector<Node*> skipped);
+    void refreshExtremes();
+    void restoreLinks();
+
+    // Join-based алгоритмы над отсоединенными поддеревьями (родитель корня - nil)
+    // Черная высота поддерева передается вместе с ним: join не спускается за ней
+    // по краю дерева и стоит O(|h1 - h2|)
+    struct Subtree {
+        Node* root;
+        size_type height;  // черных узлов на пути от корня до листа, включая корень
+
+        size_type childHeight() const {
+            return height - (root->color == Node::BLACK ? 1 : 0);
+        }
+    };
+    struct Discarded;
+    size_type blackHeight(Node* node) const;
+    Subtree measured(Node* node) const;
+    void detachChildren(Node* node, Node*& left, Node*& right);
+    Subtree joinTrees(Subtree left, Node* middle, Subtree right);
+    Subtree joinTrees(Subtree left, Subtree right);
+    void splitTree(Subtree tree, const T& key, Subtree& left, Node*& found, Subtree& right);
+    void splitLast(Subtree tree, Subtree& rest, Node*& last);
+    Subtree unionTrees(Subtree a, Subtree b, size_type depth, Discarded& discarded);
+    Subtree intersectTrees(Subtree a, Subtree b, size_type depth, Discarded& discarded);
+    Subtree differenceTrees(Subtree a, Subtree b, size_type depth, Discarded& discarded);
+    template <typename F, typename G>
+    static void forkJoin(size_type depth, F&& f, G&& g);
+
+    // Копирование и уничтожение поддеревьев без рекурсии по высоте. Большие деревья
+    // обрабатываются параллельно по независимым поддеревьям верхних уровней
+    static constexpr size_type parallelMinNodes = size_type(1) << 16;
+    Node* copyTree(Node* otherRoot, Node* otherNil, size_type count);
+    Node* copySubtree(Node* node, Node* otherNil, size_type count, size_type depth, Pool& target);
+    Node* copySerial(Node* source, Node* otherNil, Pool& target);
+    template <typename Dispose>
+    void consumeSubtree(Node* node, Dispose&& dispose);
+    void destroyValues(Node* node, size_type depth);
 
-    // Дружественный класс для итератора
-    friend class TreeIterator<T>;
+    // Построение сбалансированного дерева из отсортированной последовательности
+    template <typename It>
+    void buildSorted(It first, size_type count);
+    template <typename It>
+    Node* buildSubtree(It first, size_type count);
+    template <typename InputIt>
+    std::vector<T> sortedBatch(InputIt first, InputIt last) const;
+    template <typename It>
+    Node* buildBalanced(It& it, size_type count, size_type depth, size_type redDepth);
+    // Построение с заданной формой: links[i] - индексы детей values[i] (noChild, если нет),
+    // корень - values[0], родитель всегда раньше детей. Цвета подбираются по высотам
+    // за O(n); если форма не раскрашивается, дерево строится сбалансированным.
+    // false (дерево не тронуто), если форма не является деревом поиска
+    static constexpr size_type noChild = static_cast<size_type>(-1);
+    bool assignShape(std::vector<T>& values, const std::vector<std::pair<size_type, size_type>>& links);
+
+    // Дружественные классы для итератора и дескриптора узла
+    friend class TreeIterator<Tree>;
+    friend class TreeNodeHandle<Tree>;
+
+    template <typename K, typename V, typename C, typename A>
+    friend class TreeMap;
+
+    template <typename U>
+    friend class ConstructorsUtil;
 };
 
 // Включаем реализацию итератора после определения Tree
 #include "../iterator/iterator.hpp"
+#include "node_handle.hpp"
 
 // Реализация методов Tree
 
-template <typename T>
-Tree<T>::Tree() : treeSize(0) {
-    nil = new Node(T{});
-    nil->color = Node::BLACK;
-    nil->left = nil;
-    nil->right = nil;
-    nil->parent = nil;
-    root = nil;
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+Tree<T, Compare, Allocator, Augment, Links>::Tree() : Tree(Compare(), Allocator()) {}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+Tree<T, Compare, Allocator, Augment, Links>::Tree(const Allocator& alloc) : Tree(Compare(), alloc) {}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+Tree<T, Compare, Allocator, Augment, Links>::Tree(const Compare& comp, const Allocator& alloc)
+    : root(sentinel()), nil(sentinel()), leftmost(sentinel()), rightmost(sentinel()), treeSize(0), comp(comp),
+      pool(std::make_shared<Pool>(alloc)), alloc(alloc) {}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+typename Tree<T, Compare, Allocator, Augment, Links>::Node* Tree<T, Compare, Allocator, Augment, Links>::sentinel() {
+    // Sentinel никогда не изменяется, поэтому его можно разделять между деревьями и потоками
+    static Node node;
+    return &node;
 }
 
-template <typename T>
-Tree<T>::Tree(const Tree& other) : treeSize(0) {
-    nil = new Node(T{});
-    nil->color = Node::BLACK;
-    nil->left = nil;
-    nil->right = nil;
-    nil->parent = nil;
-    root = nil;
-    
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+template <typename InputIt>
+Tree<T, Compare, Allocator, Augment, Links>::Tree(InputIt first, InputIt last, const Compare& comp, const Allocator& alloc)
+    : Tree(comp, alloc) {
+    assign_sorted(first, last);
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+Tree<T, Compare, Allocator, Augment, Links>::Tree(const Tree& other)
+    : Tree(other.comp, std::allocator_traits<Allocator>::select_on_container_copy_construction(other.get_allocator())) {
     if (other.root != other.nil) {
-        root = copyRecursive(other.root, nil);
-        treeSize = other.treeSize;
+        treeSize = other.size();
+        root = copyTree(other.root, other.nil, treeSize);
+        restoreLinks();
     }
 }
 
-template <typename T>
-Tree<T>::Tree(Tree&& other) noexcept 
-    : root(other.root), nil(other.nil), treeSize(other.treeSize) {
-    other.root = nullptr;
-    other.nil = nullptr;
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+Tree<T, Compare, Allocator, Augment, Links>::Tree(Tree&& other) noexcept 
+    : root(other.root), nil(other.nil), leftmost(other.leftmost), rightmost(other.rightmost),
+      treeSize(other.treeSize), comp(std::move(other.comp)), pool(std::move(other.pool)),
+      alloc(other.alloc) {
+    // Пул перемещенного дерева создается заново при следующей вставке из той же копии аллокатора
+    other.root = other.nil;
+    other.leftmost = other.nil;
+    other.rightmost = other.nil;
     other.treeSize = 0;
 }
 
-template <typename T>
-Tree<T>::~Tree() {
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+Tree<T, Compare, Allocator, Augment, Links>::~Tree() {
     clear();
-    if (nil) {
-        delete nil;
-    }
 }
 
-template <typename T>
-Tree<T>& Tree<T>::operator=(const Tree& other) {
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+Tree<T, Compare, Allocator, Augment, Links>& Tree<T, Compare, Allocator, Augment, Links>::operator=(const Tree& other) {
     if (this != &other) {
         clear();
+        comp = other.comp;
         if (other.root != other.nil) {
-            root = copyRecursive(other.root, nil);
-            treeSize = other.treeSize;
+            treeSize = other.size();
+            root = copyTree(other.root, other.nil, treeSize);
+            restoreLinks();
         } else {
             root = nil;
             treeSize = 0;
@@ -146,43 +421,321 @@ Tree<T>& Tree<T>::operator=(const Tree& other) {
     return *this;
 }
 
-template <typename T>
-Tree<T>& Tree<T>::operator=(Tree&& other) noexcept {
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+Tree<T, Compare, Allocator, Augment, Links>& Tree<T, Compare, Allocator, Augment, Links>::operator=(Tree&& other) noexcept {
     if (this != &other) {
         clear();
-        if (nil) {
-            delete nil;
-        }
         root = other.root;
-        nil = other.nil;
+        leftmost = other.leftmost;
+        rightmost = other.rightmost;
         treeSize = other.treeSize;
-        other.root = nullptr;
-        other.nil = nullptr;
+        comp = std::move(other.comp);
+        pool = std::move(other.pool);
+        // Аллокатор переходит вместе с узлами, если это разрешено его свойствами
+        if constexpr (std::allocator_traits<Allocator>::propagate_on_container_move_assignment::value) {
+            alloc = other.alloc;
+        }
+        other.root = other.nil;
+        other.leftmost = other.nil;
+        other.rightmost = other.nil;
         other.treeSize = 0;
     }
     return *this;
 }
 
-template <typename T>
-typename Tree<T>::Node* Tree<T>::copyRecursive(Node* node, Node* parent) {
-    if (node == nullptr || node->left == nullptr) {
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+typename Tree<T, Compare, Allocator, Augment, Links>::Node* Tree<T, Compare, Allocator, Augment, Links>::copyTree(Node* otherRoot, Node* otherNil, size_type count) {
+    if (otherRoot == otherNil) {
+        return nil;
+    }
+    Pool& target = nodePool();
+    if (count < parallelMinNodes || ThreadPool::instance().parallelDepth() == 0) {
+        // Все узлы копии выдаются из одного заранее выделенного блока
+        target.reserve(count);
+        return copySerial(otherRoot, otherNil, target);
+    }
+    Node* top = copySubtree(otherRoot, otherNil, count, 0, target);
+    top->parent = nil;
+    return top;
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+typename Tree<T, Compare, Allocator, Augment, Links>::Node* Tree<T, Compare, Allocator, Augment, Links>::copySubtree(Node* node, Node* otherNil, size_type count, size_type depth, Pool& target) {
+    if (depth >= ThreadPool::instance().parallelDepth() || node->left == otherNil || node->right == otherNil) {
+        return copySerial(node, otherNil, target);
+    }
+    
+    // Ветви копируются в собственные пулы без блокировок, затем пул дерева
+    // поглощает их слэбы (absorb сам берет мьютексы обоих пулов).
+    // Пул ветви сразу получает блок на все ее узлы: точный размер известен из
+    // порядковых статистик, иначе берется половина (остаток уйдет в список свободных)
+    Node* copy = target.create(std::in_place, node->val);
+    copy->color = node->color;
+    size_type leftCount;
+    size_type rightCount;
+    if constexpr (Augment::hasSubtreeSize) {
+        leftCount = node->left->subtreeSize;
+        rightCount = node->right->subtreeSize;
+    } else {
+        leftCount = count > 1 ? (count - 1) / 2 : 0;
+        rightCount = count > 1 ? count - 1 - leftCount : 0;
+    }
+    Node* children[2];
+    auto copyBranch = [&](Node* source, size_type branchCount, Node*& result) {
+        Pool branchPool(target.get_allocator());
+        branchPool.reserve(branchCount);
+        result = copySubtree(source, otherNil, branchCount, depth + 1, branchPool);
+        pool->absorb(branchPool);
+    };
+    forkJoin(depth,
+        [&] { copyBranch(node->left, leftCount, children[0]); },
+        [&] { copyBranch(node->right, rightCount, children[1]); });
+    copy->left = children[0];
+    copy->right = children[1];
+    children[0]->parent = copy;
+    children[1]->parent = copy;
+    updateAugment(copy);
+    return copy;
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+typename Tree<T, Compare, Allocator, Augment, Links>::Node* Tree<T, Compare, Allocator, Augment, Links>::copySerial(Node* source, Node* otherNil, Pool& target) {
+    // Прямой обход по ссылкам на родителя: копия спускается вместе с источником,
+    // дополнение узла пересчитывается при окончательном подъеме из него
+    auto copyNode = [&](Node* from, Node* parent) {
+        Node* copy = target.create(std::in_place, from->val);
+        copy->color = from->color;
+        copy->left = nil;
+        copy->right = nil;
+        copy->parent = parent;
+        return copy;
+    };
+    
+    Node* top = copyNode(source, nil);
+    Node* from = source;
+    Node* to = top;
+    while (true) {
+        if (from->left != otherNil && to->left == nil) {
+            to->left = copyNode(from->left, to);
+            from = from->left;
+            to = to->left;
+        } else if (from->right != otherNil && to->right == nil) {
+            to->right = copyNode(from->right, to);
+            from = from->right;
+            to = to->right;
+        } else {
+            updateAugment(to);
+            if (from == source) {
+                break;
+            }
+            from = from->parent;
+            to = to->parent;
+        }
+    }
+    return top;
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+template <typename InputIt>
+void Tree<T, Compare, Allocator, Augment, Links>::assign_sorted(InputIt first, InputIt last) {
+    using Category = typename std::iterator_traits<InputIt>::iterator_category;
+    auto notLess = [this](const T& a, const T& b) { return !comp(a, b); };
+    
+    clear();
+    if constexpr (std::is_base_of<std::forward_iterator_tag, Category>::value) {
+        // Строго возрастающий вход строится без копирования
+        if (std::adjacent_find(first, last, notLess) == last) {
+            buildSorted(first, static_cast<size_type>(std::distance(first, last)));
+            return;
+        }
+    }
+    
+    std::vector<T> buffer = sortedBatch(first, last);
+    buildSorted(std::make_move_iterator(buffer.begin()), buffer.size());
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+template <typename InputIt>
+std::vector<T> Tree<T, Compare, Allocator, Augment, Links>::sortedBatch(InputIt first, InputIt last) const {
+    std::vector<T> buffer(first, last);
+    std::sort(buffer.begin(), buffer.end(), comp);
+    buffer.erase(std::unique(buffer.begin(), buffer.end(), [this](const T& a, const T& b) {
+        return !comp(a, b) && !comp(b, a);
+    }), buffer.end());
+    return buffer;
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+template <typename It>
+void Tree<T, Compare, Allocator, Augment, Links>::buildSorted(It first, size_type count) {
+    if (count == 0) {
+        return;
+    }
+    root = buildSubtree(first, count);
+    treeSize = count;
+    restoreLinks();
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+template <typename It>
+typename Tree<T, Compare, Allocator, Augment, Links>::Node* Tree<T, Compare, Allocator, Augment, Links>::buildSubtree(It first, size_type count) {
+    // При делении пополам все листья лежат на глубине floor(log2 n) или выше.
+    // Если нижний уровень неполный, он красится в красный - черная высота выравнивается.
+    size_type depth = 0;
+    while ((size_type(2) << depth) <= count) {
+        depth++;
+    }
+    size_type redDepth = ((count + 1) & count) == 0 ? count : depth;
+    
+    nodePool().reserve(count);
+    Node* top = buildBalanced(first, count, 0, redDepth);
+    top->parent = nil;
+    return top;
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+template <typename It>
+typename Tree<T, Compare, Allocator, Augment, Links>::Node* Tree<T, Compare, Allocator, Augment, Links>::buildBalanced(It& it, size_type count, size_type depth, size_type redDepth) {
+    if (count == 0) {
         return nil;
     }
     
-    Node* newNode = new Node(node->val);
-    newNode->color = node->color;
-    newNode->parent = parent;
-    newNode->left = copyRecursive(node->left, newNode);
-    newNode->right = copyRecursive(node->right, newNode);
+    size_type leftCount = (count - 1) / 2;
+    Node* left = buildBalanced(it, leftCount, depth + 1, redDepth);
     
-    if (newNode->left == nullptr) newNode->left = nil;
-    if (newNode->right == nullptr) newNode->right = nil;
+    Node* node = createNode(*it);
+    ++it;
+    node->color = depth == redDepth ? Node::RED : Node::BLACK;
+    node->left = left;
+    if (left != nil) {
+        left->parent = node;
+    }
     
-    return newNode;
+    node->right = buildBalanced(it, count - 1 - leftCount, depth + 1, redDepth);
+    if (node->right != nil) {
+        node->right->parent = node;
+    }
+    updateAugment(node);
+    return node;
 }
 
-template <typename T>
-void Tree<T>::rotateLeft(Node* x) {
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+bool Tree<T, Compare, Allocator, Augment, Links>::assignShape(std::vector<T>& values, const std::vector<std::pair<size_type, size_type>>& links) {
+    size_type count = values.size();
+    
+    // Симметричный обход с явным стеком: значения должны строго возрастать
+    std::vector<size_type> order;
+    order.reserve(count);
+    std::vector<size_type> pending;
+    size_type current = count == 0 ? noChild : 0;
+    while (current != noChild || !pending.empty()) {
+        while (current != noChild) {
+            pending.push_back(current);
+            current = links[current].first;
+        }
+        current = pending.back();
+        pending.pop_back();
+        if (!order.empty() && !comp(values[order.back()], values[current])) {
+            return false;
+        }
+        order.push_back(current);
+        current = links[current].second;
+    }
+    if (order.size() != count) {
+        return false;
+    }
+    
+    clear();
+    if (count == 0) {
+        return true;
+    }
+    
+    // Допустимые черные высоты узла (nil - 0) отрезками [first, second]: black - если узел черный,
+    // red - если красный. Черному нужны дети с высотой k - 1 любого цвета, красному - черные
+    // с высотой k. Отрезки считаются снизу вверх: дети всегда идут после родителя
+    using Range = std::pair<size_type, size_type>;
+    const Range none(1, 0);
+    auto isEmpty = [](const Range& r) { return r.first > r.second; };
+    auto meet = [](const Range& a, const Range& b) {
+        return Range(std::max(a.first, b.first), std::min(a.second, b.second));
+    };
+    std::vector<Range> black(count);
+    std::vector<Range> red(count);
+    auto anyColor = [&](size_type i) {
+        if (i == noChild) {
+            return Range(0, 0);
+        }
+        if (isEmpty(red[i])) {
+            return black[i];
+        }
+        return isEmpty(black[i]) ? red[i] : Range(std::min(black[i].first, red[i].first), std::max(black[i].second, red[i].second));
+    };
+    auto blackOnly = [&](size_type i) { return i == noChild ? Range(0, 0) : black[i]; };
+    
+    for (size_type i = count; i-- > 0;) {
+        Range children = meet(anyColor(links[i].first), anyColor(links[i].second));
+        black[i] = isEmpty(children) ? none : Range(children.first + 1, children.second + 1);
+        red[i] = meet(blackOnly(links[i].first), blackOnly(links[i].second));
+    }
+    
+    if (isEmpty(black[0])) {
+        // Форма не раскрашивается в красно-черное дерево: строим заново по порядку
+        std::vector<T> sorted;
+        sorted.reserve(count);
+        for (size_type i : order) {
+            sorted.push_back(std::move(values[i]));
+        }
+        buildSorted(std::make_move_iterator(sorted.begin()), count);
+        return true;
+    }
+    
+    // Узлы связываются как в описании, цвета и высоты раздаются сверху вниз
+    nodePool().reserve(count);
+    std::vector<Node*> nodes(count);
+    std::vector<size_type> height(count);
+    for (size_type i = 0; i < count; ++i) {
+        nodes[i] = createNode(std::move(values[i]));
+    }
+    nodes[0]->parent = nil;
+    nodes[0]->color = Node::BLACK;
+    height[0] = black[0].first;
+    for (size_type i = 0; i < count; ++i) {
+        Node* node = nodes[i];
+        bool isBlack = node->color == Node::BLACK;
+        size_type childHeight = isBlack ? height[i] - 1 : height[i];
+        size_type childIndex[] = {links[i].first, links[i].second};
+        Node* children[2] = {nil, nil};
+        for (int side = 0; side < 2; ++side) {
+            size_type c = childIndex[side];
+            if (c == noChild) {
+                continue;
+            }
+            children[side] = nodes[c];
+            nodes[c]->parent = node;
+            height[c] = childHeight;
+            bool fitsBlack = black[c].first <= childHeight && childHeight <= black[c].second;
+            nodes[c]->color = !isBlack || fitsBlack ? Node::BLACK : Node::RED;
+        }
+        node->left = children[0];
+        node->right = children[1];
+    }
+    for (size_type i = count; i-- > 0;) {
+        updateAugment(nodes[i]);
+    }
+    
+    root = nodes[0];
+    treeSize = count;
+    restoreLinks();
+    return true;
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+void Tree<T, Compare, Allocator, Augment, Links>::rotateLeft(Node* x) {
+    rotateLeft(x, root);
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+void Tree<T, Compare, Allocator, Augment, Links>::rotateLeft(Node* x, Node*& top) {
     Node* y = x->right;
     x->right = y->left;
     
@@ -193,7 +746,7 @@ void Tree<T>::rotateLeft(Node* x) {
     y->parent = x->parent;
     
     if (x->parent == nil) {
-        root = y;
+        top = y;
     } else if (x == x->parent->left) {
         x->parent->left = y;
     } else {
@@ -202,10 +755,18 @@ void Tree<T>::rotateLeft(Node* x) {
     
     y->left = x;
     x->parent = y;
+    
+    updateAugment(x);
+    updateAugment(y);
 }
 
-template <typename T>
-void Tree<T>::rotateRight(Node* x) {
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+void Tree<T, Compare, Allocator, Augment, Links>::rotateRight(Node* x) {
+    rotateRight(x, root);
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+void Tree<T, Compare, Allocator, Augment, Links>::rotateRight(Node* x, Node*& top) {
     Node* y = x->left;
     x->left = y->right;
     
@@ -216,7 +777,7 @@ void Tree<T>::rotateRight(Node* x) {
     y->parent = x->parent;
     
     if (x->parent == nil) {
-        root = y;
+        top = y;
     } else if (x == x->parent->right) {
         x->parent->right = y;
     } else {
@@ -225,10 +786,18 @@ void Tree<T>::rotateRight(Node* x) {
     
     y->right = x;
     x->parent = y;
+    
+    updateAugment(x);
+    updateAugment(y);
 }
 
-template <typename T>
-void Tree<T>::fixInsert(Node* z) {
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+void Tree<T, Compare, Allocator, Augment, Links>::fixInsert(Node* z) {
+    fixInsert(z, root);
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+bool Tree<T, Compare, Allocator, Augment, Links>::fixInsert(Node* z, Node*& top) {
     while (z->parent->color == Node::RED) {
         if (z->parent == z->parent->parent->left) {
             Node* y = z->parent->parent->right;
@@ -240,11 +809,11 @@ void Tree<T>::fixInsert(Node* z) {
             } else {
                 if (z == z->parent->right) {
                     z = z->parent;
-                    rotateLeft(z);
+                    rotateLeft(z, top);
                 }
                 z->parent->color = Node::BLACK;
                 z->parent->parent->color = Node::RED;
-                rotateRight(z->parent->parent);
+                rotateRight(z->parent->parent, top);
             }
         } else {
             Node* y = z->parent->parent->left;
@@ -256,35 +825,140 @@ void Tree<T>::fixInsert(Node* z) {
             } else {
                 if (z == z->parent->left) {
                     z = z->parent;
-                    rotateRight(z);
+                    rotateRight(z, top);
                 }
                 z->parent->color = Node::BLACK;
                 z->parent->parent->color = Node::RED;
-                rotateLeft(z->parent->parent);
+                rotateLeft(z->parent->parent, top);
             }
         }
     }
-    root->color = Node::BLACK;
+    bool grown = top->color == Node::RED;
+    top->color = Node::BLACK;
+    return grown;
 }
 
-template <typename T>
-std::pair<typename Tree<T>::iterator, bool> Tree<T>::insert(const T& value) {
-    Node* y = nil;
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+void Tree<T, Compare, Allocator, Augment, Links>::updateAugment(Node* node) {
+    if constexpr (Augment::enabled) {
+        Augment::update(node);
+    }
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+void Tree<T, Compare, Allocator, Augment, Links>::updatePath(Node* node) {
+    if constexpr (Augment::enabled) {
+        while (node != nil) {
+            Augment::update(node);
+            node = node->parent;
+        }
+    }
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+template <typename... Args>
+typename Tree<T, Compare, Allocator, Augment, Links>::Node* Tree<T, Compare, Allocator, Augment, Links>::createNode(Args&&... args) {
+    return nodePool().create(std::in_place, std::forward<Args>(args)...);
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+void Tree<T, Compare, Allocator, Augment, Links>::destroyNode(Node* node) {
+    node->val.~T();
+    pool->destroy(node);
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+typename Tree<T, Compare, Allocator, Augment, Links>::Pool& Tree<T, Compare, Allocator, Augment, Links>::nodePool() {
+    if (!pool) {
+        pool = std::make_shared<Pool>(alloc);
+    }
+    return *pool;
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+bool Tree<T, Compare, Allocator, Augment, Links>::sharePoolWith(Tree& other) {
+    // Узлы можно переносить между деревьями только внутри одного пула.
+    // Пул, которым владеет одно дерево, поглощается пулом другого.
+    nodePool();
+    other.nodePool();
+    return sharePool(other.pool);
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+bool Tree<T, Compare, Allocator, Augment, Links>::sharePool(std::shared_ptr<Pool>& otherPool) {
+    if (pool == otherPool) {
+        return true;
+    }
+    if (otherPool.use_count() == 1 && pool->absorb(*otherPool)) {
+        otherPool = pool;
+    } else if (pool.use_count() == 1 && otherPool->absorb(*pool)) {
+        pool = otherPool;
+    } else {
+        return false;
+    }
+    pool->markShared();
+    return true;
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+typename Tree<T, Compare, Allocator, Augment, Links>::Node* Tree<T, Compare, Allocator, Augment, Links>::adoptNode(node_type& handle) {
+    nodePool();
+    if (sharePool(handle.pool)) {
+        return handle.release();
+    }
+    // Пулы не объединить (оба общие или аллокаторы не равны): значение переезжает
+    Node* z = createNode(std::move(handle.node->val));
+    handle.reset();
+    return z;
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+void Tree<T, Compare, Allocator, Augment, Links>::adjustSize(size_type added, size_type removed) {
+    treeSize = treeSize + added - removed;
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+template <typename K>
+typename Tree<T, Compare, Allocator, Augment, Links>::Node* Tree<T, Compare, Allocator, Augment, Links>::findInsertParent(const K& value, Node*& parent, bool& asLeft) const {
+    parent = nil;
+    asLeft = true;
     Node* x = root;
     
-    while (x != nil) {
-        y = x;
-        if (value < x->val) {
-            x = x->left;
-        } else if (x->val < value) {
-            x = x->right;
-        } else {
+    if constexpr (tree_detail::hasThreeWay<Compare, T, K, T>()) {
+        while (x != nil) {
+            parent = x;
+            int c = tree_detail::threeWay<Compare, T>(comp, value, x->val);
+            if (c == 0) {
+                // Элемент уже существует
+                return x;
+            }
+            asLeft = c < 0;
+            x = asLeft ? x->left : x->right;
+        }
+        return nil;
+    } else {
+        // Одно сравнение на уровень; кандидат в дубликаты - последний узел, от которого ушли вправо
+        Node* candidate = nil;
+        while (x != nil) {
+            parent = x;
+            asLeft = comp(value, x->val);
+            if (asLeft) {
+                x = x->left;
+            } else {
+                candidate = x;
+                x = x->right;
+            }
+        }
+        if (candidate != nil && !comp(candidate->val, value)) {
             // Элемент уже существует
-            return std::make_pair(iterator(x, nil, this), false);
+            return candidate;
         }
+        return nil;
     }
-    
-    Node* z = new Node(value);
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+void Tree<T, Compare, Allocator, Augment, Links>::linkNode(Node* z, Node* y, bool asLeft) {
     z->parent = y;
     z->left = nil;
     z->right = nil;
@@ -292,20 +966,186 @@ std::pair<typename Tree<T>::iterator, bool> Tree<T>::insert(const T& value) {
     
     if (y == nil) {
         root = z;
-    } else if (z->val < y->val) {
+        leftmost = z;
+        rightmost = z;
+    } else if (asLeft) {
         y->left = z;
+        if (y == leftmost) {
+            leftmost = z;
+        }
     } else {
         y->right = z;
+        if (y == rightmost) {
+            rightmost = z;
+        }
     }
     
-    treeSize++;
+    // Левый ребенок встает сразу перед родителем, правый - сразу после
+    if constexpr (Links::threaded) {
+        Node* prev = y == nil ? nil : (asLeft ? y->prev : y);
+        Node* next = y == nil ? nil : (asLeft ? y : y->next);
+        z->prev = prev;
+        z->next = next;
+        if (prev != nil) {
+            prev->next = z;
+        }
+        if (next != nil) {
+            next->prev = z;
+        }
+    }
+    
+    updatePath(z);
+    adjustSize(1, 0);
     fixInsert(z);
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+template <typename V>
+std::pair<typename Tree<T, Compare, Allocator, Augment, Links>::iterator, bool> Tree<T, Compare, Allocator, Augment, Links>::insertValue(V&& value) {
+    Node* y;
+    bool asLeft;
+    Node* existing = findInsertParent(value, y, asLeft);
+    if (existing != nil) {
+        return std::make_pair(iterator(existing, nil, this), false);
+    }
     
+    Node* z = createNode(std::forward<V>(value));
+    linkNode(z, y, asLeft);
     return std::make_pair(iterator(z, nil, this), true);
 }
 
-template <typename T>
-void Tree<T>::transplant(Node* u, Node* v) {
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+template <typename K, typename... Args>
+std::pair<typename Tree<T, Compare, Allocator, Augment, Links>::iterator, bool> Tree<T, Compare, Allocator, Augment, Links>::emplaceKey(const K& key, Args&&... args) {
+    Node* y;
+    bool asLeft;
+    Node* existing = findInsertParent(key, y, asLeft);
+    if (existing != nil) {
+        return std::make_pair(iterator(existing, nil, this), false);
+    }
+    
+    Node* z = createNode(std::forward<Args>(args)...);
+    linkNode(z, y, asLeft);
+    return std::make_pair(iterator(z, nil, this), true);
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+std::pair<typename Tree<T, Compare, Allocator, Augment, Links>::iterator, bool> Tree<T, Compare, Allocator, Augment, Links>::insert(const T& value) {
+    return insertValue(value);
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+std::pair<typename Tree<T, Compare, Allocator, Augment, Links>::iterator, bool> Tree<T, Compare, Allocator, Augment, Links>::insert(T&& value) {
+    return insertValue(std::move(value));
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+template <typename V>
+typename Tree<T, Compare, Allocator, Augment, Links>::iterator Tree<T, Compare, Allocator, Augment, Links>::insertHint(Node* hint, V&& value) {
+    // Новое значение должно лечь между hint и его соседом; тогда у одного из них
+    // нужная сторона свободна (сосед - крайний узел поддерева hint)
+    Node* parent = nil;
+    bool asLeft = true;
+    if (root == nil) {
+        return insertValue(std::forward<V>(value)).first;
+    }
+    if (hint == nil) {
+        Node* last = rightmost;
+        if (!comp(last->val, value)) {
+            return insertValue(std::forward<V>(value)).first;
+        }
+        parent = last;
+        asLeft = false;
+    } else if (comp(value, hint->val)) {
+        Node* prev = prevNode(hint);
+        if (prev != nil && !comp(prev->val, value)) {
+            return insertValue(std::forward<V>(value)).first;
+        }
+        asLeft = hint->left == nil;
+        parent = asLeft ? hint : prev;
+    } else if (comp(hint->val, value)) {
+        Node* next = nextNode(hint);
+        if (next != nil && !comp(value, next->val)) {
+            return insertValue(std::forward<V>(value)).first;
+        }
+        asLeft = hint->right != nil;
+        parent = asLeft ? next : hint;
+    } else {
+        // Элемент уже существует
+        return iterator(hint, nil, this);
+    }
+    
+    Node* z = createNode(std::forward<V>(value));
+    linkNode(z, parent, asLeft);
+    return iterator(z, nil, this);
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+typename Tree<T, Compare, Allocator, Augment, Links>::iterator Tree<T, Compare, Allocator, Augment, Links>::insert(iterator hint, const T& value) {
+    return insertHint(hint.getNode(), value);
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+typename Tree<T, Compare, Allocator, Augment, Links>::iterator Tree<T, Compare, Allocator, Augment, Links>::insert(iterator hint, T&& value) {
+    return insertHint(hint.getNode(), std::move(value));
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+template <typename InputIt>
+void Tree<T, Compare, Allocator, Augment, Links>::insert_range(InputIt first, InputIt last) {
+    std::vector<T> buffer = sortedBatch(first, last);
+    if (buffer.empty()) {
+        return;
+    }
+    
+    // Пакет собирается в сбалансированное поддерево за O(m) и объединяется с деревом.
+    // Пакет стоит первым аргументом: при совпадении ключей остается уже существующий узел
+    Node* batch = buildSubtree(std::make_move_iterator(buffer.begin()), buffer.size());
+    std::vector<Node*> added;
+    if constexpr (Links::threaded) {
+        added.reserve(buffer.size());
+        for (Node* node = minimum(batch); node != nil; node = successor(node)) {
+            added.push_back(node);
+        }
+    }
+    Discarded discarded;
+    root = unionTrees(measured(batch), measured(root), 0, discarded).root;
+    root->color = Node::BLACK;
+    threadNodes(added, discarded.nodes);
+    refreshExtremes();
+    for (Node* node : discarded.nodes) {
+        destroyNode(node);
+    }
+    adjustSize(buffer.size(), discarded.nodes.size());
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+template <typename InputIt>
+void Tree<T, Compare, Allocator, Augment, Links>::erase_range(InputIt first, InputIt last) {
+    Tree batch(comp, get_allocator());
+    batch.assign_sorted(first, last);
+    difference_with(batch);
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+template <typename... Args>
+std::pair<typename Tree<T, Compare, Allocator, Augment, Links>::iterator, bool> Tree<T, Compare, Allocator, Augment, Links>::emplace(Args&&... args) {
+    // Значение конструируется сразу в узле; при дубликате узел возвращается в пул
+    Node* z = createNode(std::forward<Args>(args)...);
+    Node* y;
+    bool asLeft;
+    Node* existing = findInsertParent(z->val, y, asLeft);
+    if (existing != nil) {
+        destroyNode(z);
+        return std::make_pair(iterator(existing, nil, this), false);
+    }
+    
+    linkNode(z, y, asLeft);
+    return std::make_pair(iterator(z, nil, this), true);
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+void Tree<T, Compare, Allocator, Augment, Links>::transplant(Node* u, Node* v) {
     if (u->parent == nil) {
         root = v;
     } else if (u == u->parent->left) {
@@ -313,27 +1153,29 @@ void Tree<T>::transplant(Node* u, Node* v) {
     } else {
         u->parent->right = v;
     }
-    v->parent = u->parent;
+    if (v != nil) {
+        v->parent = u->parent;
+    }
 }
 
-template <typename T>
-typename Tree<T>::Node* Tree<T>::minimum(Node* node) const {
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+typename Tree<T, Compare, Allocator, Augment, Links>::Node* Tree<T, Compare, Allocator, Augment, Links>::minimum(Node* node) const {
     while (node->left != nil) {
         node = node->left;
     }
     return node;
 }
 
-template <typename T>
-typename Tree<T>::Node* Tree<T>::maximum(Node* node) const {
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+typename Tree<T, Compare, Allocator, Augment, Links>::Node* Tree<T, Compare, Allocator, Augment, Links>::maximum(Node* node) const {
     while (node->right != nil) {
         node = node->right;
     }
     return node;
 }
 
-template <typename T>
-typename Tree<T>::Node* Tree<T>::successor(Node* node) const {
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+typename Tree<T, Compare, Allocator, Augment, Links>::Node* Tree<T, Compare, Allocator, Augment, Links>::successor(Node* node) const {
     if (node->right != nil) {
         return minimum(node->right);
     }
@@ -346,8 +1188,8 @@ typename Tree<T>::Node* Tree<T>::successor(Node* node) const {
     return y;
 }
 
-template <typename T>
-typename Tree<T>::Node* Tree<T>::predecessor(Node* node) const {
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+typename Tree<T, Compare, Allocator, Augment, Links>::Node* Tree<T, Compare, Allocator, Augment, Links>::predecessor(Node* node) const {
     if (node->left != nil) {
         return maximum(node->left);
     }
@@ -360,86 +1202,286 @@ typename Tree<T>::Node* Tree<T>::predecessor(Node* node) const {
     return y;
 }
 
-template <typename T>
-void Tree<T>::fixDelete(Node* x) {
-    while (x != root && x->color == Node::BLACK) {
-        if (x == x->parent->left) {
-            Node* w = x->parent->right;
-            if (w->color == Node::RED) {
-                w->color = Node::BLACK;
-                x->parent->color = Node::RED;
-                rotateLeft(x->parent);
-                w = x->parent->right;
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+typename Tree<T, Compare, Allocator, Augment, Links>::Node* Tree<T, Compare, Allocator, Augment, Links>::nextNode(Node* node) const {
+    if constexpr (Links::threaded) {
+        return node->next;
+    } else {
+        return successor(node);
+    }
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+typename Tree<T, Compare, Allocator, Augment, Links>::Node* Tree<T, Compare, Allocator, Augment, Links>::prevNode(Node* node) const {
+    if constexpr (Links::threaded) {
+        return node->prev;
+    } else {
+        return predecessor(node);
+    }
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+void Tree<T, Compare, Allocator, Augment, Links>::unthread(Node* node) {
+    if constexpr (Links::threaded) {
+        if (node->prev != nil) {
+            node->prev->next = node->next;
+        }
+        if (node->next != nil) {
+            node->next->prev = node->prev;
+        }
+    }
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+void Tree<T, Compare, Allocator, Augment, Links>::threadNodes(const std::vector<Node*>& added, std::vector<Node*> skipped) {
+    // Новые узлы (по возрастанию) вплетаются в список после соседа слева по дереву;
+    // узлы из skipped в дерево не попали. Старый список уже связан, и к очередному
+    // узлу все его левые соседи тоже
+    if constexpr (Links::threaded) {
+        std::sort(skipped.begin(), skipped.end());
+        Node* head = leftmost;
+        for (Node* node : added) {
+            if (std::binary_search(skipped.begin(), skipped.end(), node)) {
+                continue;
             }
-            if (w->left->color == Node::BLACK && w->right->color == Node::BLACK) {
-                w->color = Node::RED;
-                x = x->parent;
+            Node* prev = predecessor(node);
+            Node* next = prev == nil ? head : prev->next;
+            node->prev = prev;
+            node->next = next;
+            if (prev != nil) {
+                prev->next = node;
             } else {
-                if (w->right->color == Node::BLACK) {
-                    w->left->color = Node::BLACK;
-                    w->color = Node::RED;
-                    rotateRight(w);
-                    w = x->parent->right;
-                }
-                w->color = x->parent->color;
-                x->parent->color = Node::BLACK;
-                w->right->color = Node::BLACK;
-                rotateLeft(x->parent);
-                x = root;
+                head = node;
             }
-        } else {
-            Node* w = x->parent->left;
-            if (w->color == Node::RED) {
-                w->color = Node::BLACK;
-                x->parent->color = Node::RED;
-                rotateRight(x->parent);
-                w = x->parent->left;
+            if (next != nil) {
+                next->prev = node;
+            }
+        }
+    } else {
+        (void)added;
+        (void)skipped;
+    }
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+void Tree<T, Compare, Allocator, Augment, Links>::refreshExtremes() {
+    leftmost = root == nil ? nil : minimum(root);
+    rightmost = root == nil ? nil : maximum(root);
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+void Tree<T, Compare, Allocator, Augment, Links>::restoreLinks() {
+    // Полная перепрошивка после построения или копирования дерева, O(n)
+    refreshExtremes();
+    if constexpr (Links::threaded) {
+        Node* prev = nil;
+        for (Node* node = leftmost; node != nil; node = successor(node)) {
+            node->prev = prev;
+            if (prev != nil) {
+                prev->next = node;
+            }
+            prev = node;
+        }
+        if (prev != nil) {
+            prev->next = nil;
+        }
+    }
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+void Tree<T, Compare, Allocator, Augment, Links>::fixDelete(Node* x, Node* xParent) {
+    // x может быть sentinel-узлом, поэтому его родитель передается явно
+    while (x != root && x->color == Node::BLACK) {
+        if (x == xParent->left) {
+            Node* w = xParent->right;
+            if (w->color == Node::RED) {
+                w->color = Node::BLACK;
+                xParent->color = Node::RED;
+                rotateLeft(xParent);
+                w = xParent->right;
+            }
+            if (w->left->color == Node::BLACK && w->right->color == Node::BLACK) {
+                w->color = Node::RED;
+                x = xParent;
+                xParent = x->parent;
+            } else {
+                if (w->right->color == Node::BLACK) {
+                    w->left->color = Node::BLACK;
+                    w->color = Node::RED;
+                    rotateRight(w);
+                    w = xParent->right;
+                }
+                w->color = xParent->color;
+                xParent->color = Node::BLACK;
+                w->right->color = Node::BLACK;
+                rotateLeft(xParent);
+                x = root;
+            }
+        } else {
+            Node* w = xParent->left;
+            if (w->color == Node::RED) {
+                w->color = Node::BLACK;
+                xParent->color = Node::RED;
+                rotateRight(xParent);
+                w = xParent->left;
             }
             if (w->right->color == Node::BLACK && w->left->color == Node::BLACK) {
                 w->color = Node::RED;
-                x = x->parent;
+                x = xParent;
+                xParent = x->parent;
             } else {
                 if (w->left->color == Node::BLACK) {
                     w->right->color = Node::BLACK;
                     w->color = Node::RED;
                     rotateLeft(w);
-                    w = x->parent->left;
+                    w = xParent->left;
                 }
-                w->color = x->parent->color;
-                x->parent->color = Node::BLACK;
+                w->color = xParent->color;
+                xParent->color = Node::BLACK;
                 w->left->color = Node::BLACK;
-                rotateRight(x->parent);
+                rotateRight(xParent);
                 x = root;
             }
         }
     }
-    x->color = Node::BLACK;
+    if (x != nil) {
+        x->color = Node::BLACK;
+    }
 }
 
-template <typename T>
-typename Tree<T>::size_type Tree<T>::erase(const T& value) {
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+typename Tree<T, Compare, Allocator, Augment, Links>::size_type Tree<T, Compare, Allocator, Augment, Links>::erase(const T& value) {
     Node* z = search(root, value);
     if (z == nil) {
         return 0;
     }
+    eraseNode(z);
+    return 1;
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+typename Tree<T, Compare, Allocator, Augment, Links>::iterator Tree<T, Compare, Allocator, Augment, Links>::erase(iterator position) {
+    Node* z = position.getNode();
+    if (z == nil || z == nullptr) {
+        return end();
+    }
+    // Узлы при удалении перевешиваются, а не копируются: следующий узел остается на месте
+    Node* next = nextNode(z);
+    eraseNode(z);
+    return iterator(next, nil, this);
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+template <typename K, typename C, typename>
+typename Tree<T, Compare, Allocator, Augment, Links>::size_type Tree<T, Compare, Allocator, Augment, Links>::erase(const K& key) {
+    Node* z = search(root, key);
+    if (z == nil) {
+        return 0;
+    }
+    eraseNode(z);
+    return 1;
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+typename Tree<T, Compare, Allocator, Augment, Links>::node_type Tree<T, Compare, Allocator, Augment, Links>::extract(iterator position) {
+    Node* z = position.getNode();
+    if (z == nil || z == nullptr) {
+        return node_type();
+    }
+    unlinkNode(z);
+    return node_type(z, pool);
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+typename Tree<T, Compare, Allocator, Augment, Links>::node_type Tree<T, Compare, Allocator, Augment, Links>::extract(const T& value) {
+    Node* z = search(root, value);
+    if (z == nil) {
+        return node_type();
+    }
+    unlinkNode(z);
+    return node_type(z, pool);
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+typename Tree<T, Compare, Allocator, Augment, Links>::insert_return_type Tree<T, Compare, Allocator, Augment, Links>::insert(node_type&& node) {
+    if (node.empty()) {
+        return {end(), false, node_type()};
+    }
+    Node* y;
+    bool asLeft;
+    Node* existing = findInsertParent(node.node->val, y, asLeft);
+    if (existing != nil) {
+        return {iterator(existing, nil, this), false, std::move(node)};
+    }
+    
+    Node* z = adoptNode(node);
+    linkNode(z, y, asLeft);
+    return {iterator(z, nil, this), true, node_type()};
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+void Tree<T, Compare, Allocator, Augment, Links>::merge(Tree& source) {
+    if (this == &source || source.root == nil) {
+        return;
+    }
+    // С общим пулом узлы source перевешиваются сюда по одному, иначе значения переезжают
+    bool samePool = sharePoolWith(source);
+    Node* z = source.leftmost;
+    while (z != nil) {
+        Node* next = source.nextNode(z);
+        Node* y;
+        bool asLeft;
+        if (findInsertParent(z->val, y, asLeft) == nil) {
+            source.unlinkNode(z);
+            if (samePool) {
+                linkNode(z, y, asLeft);
+            } else {
+                linkNode(createNode(std::move(z->val)), y, asLeft);
+                source.destroyNode(z);
+            }
+        }
+        z = next;
+    }
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+void Tree<T, Compare, Allocator, Augment, Links>::eraseNode(Node* z) {
+    unlinkNode(z);
+    destroyNode(z);
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+void Tree<T, Compare, Allocator, Augment, Links>::unlinkNode(Node* z) {
+    if (z == leftmost) {
+        leftmost = nextNode(z);
+    }
+    if (z == rightmost) {
+        rightmost = prevNode(z);
+    }
+    unthread(z);
     
     Node* y = z;
     Node* x;
     typename Node::Color yOriginalColor = y->color;
     
+    Node* xParent;
+    
     if (z->left == nil) {
         x = z->right;
+        xParent = z->parent;
         transplant(z, z->right);
     } else if (z->right == nil) {
         x = z->left;
+        xParent = z->parent;
         transplant(z, z->left);
     } else {
         y = minimum(z->right);
         yOriginalColor = y->color;
         x = y->right;
         if (y->parent == z) {
-            x->parent = y;
+            xParent = y;
         } else {
+            xParent = y->parent;
             transplant(y, y->right);
             y->right = z->right;
             y->right->parent = y;
@@ -450,30 +1492,48 @@ typename Tree<T>::size_type Tree<T>::erase(const T& value) {
         y->color = z->color;
     }
     
-    delete z;
-    treeSize--;
+    adjustSize(0, 1);
+    
+    // Данные изменились от родителя x до корня; дальше их поддерживают вращения
+    updatePath(xParent);
     
     if (yOriginalColor == Node::BLACK) {
-        fixDelete(x);
+        fixDelete(x, xParent);
     }
-    
-    return 1;
 }
 
-template <typename T>
-typename Tree<T>::Node* Tree<T>::search(Node* node, const T& value) const {
-    while (node != nil && node->val != value) {
-        if (value < node->val) {
-            node = node->left;
-        } else {
-            node = node->right;
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+template <typename K>
+typename Tree<T, Compare, Allocator, Augment, Links>::Node* Tree<T, Compare, Allocator, Augment, Links>::search(Node* node, const K& key) const {
+    if constexpr (tree_detail::hasThreeWay<Compare, T, K, T>()) {
+        while (node != nil) {
+            int c = tree_detail::threeWay<Compare, T>(comp, key, node->val);
+            if (c == 0) {
+                return node;
+            }
+            node = c < 0 ? node->left : node->right;
         }
+        return nil;
+    } else {
+        // Спуск как в lower_bound: одно сравнение на уровень и одна проверка в конце
+        Node* candidate = nil;
+        while (node != nil) {
+            if (!comp(node->val, key)) {
+                candidate = node;
+                node = node->left;
+            } else {
+                node = node->right;
+            }
+        }
+        if (candidate != nil && !comp(key, candidate->val)) {
+            return candidate;
+        }
+        return nil;
     }
-    return node;
 }
 
-template <typename T>
-typename Tree<T>::iterator Tree<T>::find(const T& value) {
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+typename Tree<T, Compare, Allocator, Augment, Links>::iterator Tree<T, Compare, Allocator, Augment, Links>::find(const T& value) {
     Node* node = search(root, value);
     if (node == nil) {
         return end();
@@ -481,66 +1541,876 @@ typename Tree<T>::iterator Tree<T>::find(const T& value) {
     return iterator(node, nil, this);
 }
 
-template <typename T>
-typename Tree<T>::iterator Tree<T>::begin() {
-    if (root == nil) {
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+template <typename K, typename C, typename>
+typename Tree<T, Compare, Allocator, Augment, Links>::iterator Tree<T, Compare, Allocator, Augment, Links>::find(const K& key) {
+    Node* node = search(root, key);
+    if (node == nil) {
         return end();
     }
-    return iterator(minimum(root), nil, this);
+    return iterator(node, nil, this);
 }
 
-template <typename T>
-typename Tree<T>::iterator Tree<T>::end() {
-    return iterator(nil, nil, this);
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+template <typename K>
+typename Tree<T, Compare, Allocator, Augment, Links>::Node* Tree<T, Compare, Allocator, Augment, Links>::lowerBound(const K& key) const {
+    // Первый узел, не меньший key
+    Node* node = root;
+    Node* result = nil;
+    while (node != nil) {
+        if (!comp(node->val, key)) {
+            result = node;
+            node = node->left;
+        } else {
+            node = node->right;
+        }
+    }
+    return result;
 }
 
-template <typename T>
-typename Tree<T>::iterator Tree<T>::begin() const {
-    if (root == nil) {
-        return end();
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+template <typename K>
+typename Tree<T, Compare, Allocator, Augment, Links>::Node* Tree<T, Compare, Allocator, Augment, Links>::upperBound(const K& key) const {
+    // Первый узел, строго больший key
+    Node* node = root;
+    Node* result = nil;
+    while (node != nil) {
+        if (comp(key, node->val)) {
+            result = node;
+            node = node->left;
+        } else {
+            node = node->right;
+        }
     }
-    return iterator(minimum(root), nil, this);
+    return result;
 }
 
-template <typename T>
-typename Tree<T>::iterator Tree<T>::end() const {
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+template <typename K>
+std::pair<typename Tree<T, Compare, Allocator, Augment, Links>::iterator, typename Tree<T, Compare, Allocator, Augment, Links>::iterator>
+Tree<T, Compare, Allocator, Augment, Links>::equalRange(const K& key) const {
+    // Ключи уникальны: диапазон пуст или состоит из одного узла
+    Node* lower = lowerBound(key);
+    Node* upper = lower;
+    if (lower != nil && !comp(key, lower->val)) {
+        upper = successor(lower);
+    }
+    return std::make_pair(iterator(lower, nil, this), iterator(upper, nil, this));
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+typename Tree<T, Compare, Allocator, Augment, Links>::iterator Tree<T, Compare, Allocator, Augment, Links>::lower_bound(const T& value) const {
+    return iterator(lowerBound(value), nil, this);
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+typename Tree<T, Compare, Allocator, Augment, Links>::iterator Tree<T, Compare, Allocator, Augment, Links>::upper_bound(const T& value) const {
+    return iterator(upperBound(value), nil, this);
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+std::pair<typename Tree<T, Compare, Allocator, Augment, Links>::iterator, typename Tree<T, Compare, Allocator, Augment, Links>::iterator>
+Tree<T, Compare, Allocator, Augment, Links>::equal_range(const T& value) const {
+    return equalRange(value);
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+typename Tree<T, Compare, Allocator, Augment, Links>::size_type Tree<T, Compare, Allocator, Augment, Links>::count(const T& value) const {
+    return search(root, value) != nil ? 1 : 0;
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+bool Tree<T, Compare, Allocator, Augment, Links>::contains(const T& value) const {
+    return search(root, value) != nil;
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+template <typename K, typename C, typename>
+typename Tree<T, Compare, Allocator, Augment, Links>::iterator Tree<T, Compare, Allocator, Augment, Links>::lower_bound(const K& key) const {
+    return iterator(lowerBound(key), nil, this);
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+template <typename K, typename C, typename>
+typename Tree<T, Compare, Allocator, Augment, Links>::iterator Tree<T, Compare, Allocator, Augment, Links>::upper_bound(const K& key) const {
+    return iterator(upperBound(key), nil, this);
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+template <typename K, typename C, typename>
+std::pair<typename Tree<T, Compare, Allocator, Augment, Links>::iterator, typename Tree<T, Compare, Allocator, Augment, Links>::iterator>
+Tree<T, Compare, Allocator, Augment, Links>::equal_range(const K& key) const {
+    return equalRange(key);
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+template <typename K, typename C, typename>
+typename Tree<T, Compare, Allocator, Augment, Links>::size_type Tree<T, Compare, Allocator, Augment, Links>::count(const K& key) const {
+    return search(root, key) != nil ? 1 : 0;
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+template <typename K, typename C, typename>
+bool Tree<T, Compare, Allocator, Augment, Links>::contains(const K& key) const {
+    return search(root, key) != nil;
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+template <typename ForwardIt, typename Emit>
+void Tree<T, Compare, Allocator, Augment, Links>::searchMany(ForwardIt first, ForwardIt last, Emit emit) const {
+    // Группа спусков продвигается по уровню за проход; следующий узел каждого
+    // подгружается заранее и к следующему проходу обычно уже в кэше
+    constexpr size_type groupSize = 16;
+    ForwardIt keys[groupSize];
+    Node* current[groupSize];
+    Node* candidate[groupSize];
+
+    while (first != last) {
+        size_type count = 0;
+        for (; count < groupSize && first != last; ++count, ++first) {
+            keys[count] = first;
+            current[count] = root;
+            candidate[count] = nil;
+        }
+
+        bool active = true;
+        while (active) {
+            active = false;
+            for (size_type i = 0; i < count; ++i) {
+                Node* node = current[i];
+                if (node == nil) {
+                    continue;
+                }
+                // Спуск как в lower_bound: одно сравнение на уровень
+                if (!comp(node->val, *keys[i])) {
+                    candidate[i] = node;
+                    node = node->left;
+                } else {
+                    node = node->right;
+                }
+                tree_detail::prefetch(node);
+                current[i] = node;
+                active = active || node != nil;
+            }
+        }
+
+        for (size_type i = 0; i < count; ++i) {
+            Node* node = candidate[i];
+            emit(node != nil && !comp(*keys[i], node->val) ? node : nil);
+        }
+    }
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+template <typename ForwardIt, typename OutputIt>
+OutputIt Tree<T, Compare, Allocator, Augment, Links>::find_many(ForwardIt first, ForwardIt last, OutputIt out) {
+    searchMany(first, last, [this, &out](Node* node) {
+        *out = iterator(node, nil, this);
+        ++out;
+    });
+    return out;
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+template <typename ForwardIt, typename OutputIt>
+OutputIt Tree<T, Compare, Allocator, Augment, Links>::contains_many(ForwardIt first, ForwardIt last, OutputIt out) const {
+    searchMany(first, last, [this, &out](Node* node) {
+        *out = node != nil;
+        ++out;
+    });
+    return out;
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+typename Tree<T, Compare, Allocator, Augment, Links>::iterator Tree<T, Compare, Allocator, Augment, Links>::begin() {
+    return iterator(leftmost, nil, this);
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+typename Tree<T, Compare, Allocator, Augment, Links>::iterator Tree<T, Compare, Allocator, Augment, Links>::end() {
     return iterator(nil, nil, this);
 }
 
-template <typename T>
-typename Tree<T>::iterator Tree<T>::cbegin() const {
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+typename Tree<T, Compare, Allocator, Augment, Links>::iterator Tree<T, Compare, Allocator, Augment, Links>::begin() const {
+    return iterator(leftmost, nil, this);
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+typename Tree<T, Compare, Allocator, Augment, Links>::iterator Tree<T, Compare, Allocator, Augment, Links>::end() const {
+    return iterator(nil, nil, this);
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+typename Tree<T, Compare, Allocator, Augment, Links>::iterator Tree<T, Compare, Allocator, Augment, Links>::cbegin() const {
     return begin();
 }
 
-template <typename T>
-typename Tree<T>::iterator Tree<T>::cend() const {
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+typename Tree<T, Compare, Allocator, Augment, Links>::iterator Tree<T, Compare, Allocator, Augment, Links>::cend() const {
     return end();
 }
 
-template <typename T>
-typename Tree<T>::size_type Tree<T>::size() const {
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+struct Tree<T, Compare, Allocator, Augment, Links>::Discarded {
+    // Узлы, выброшенные параллельной операцией; освобождаются после нее
+    std::mutex mutex;
+    std::vector<Node*> nodes;
+
+    void add(Node* node) {
+        std::lock_guard<std::mutex> lock(mutex);
+        nodes.push_back(node);
+    }
+};
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+template <typename F, typename G>
+void Tree<T, Compare, Allocator, Augment, Links>::forkJoin(size_type depth, F&& f, G&& g) {
+    ThreadPool& threads = ThreadPool::instance();
+    if (depth < threads.parallelDepth()) {
+        threads.invoke(std::forward<F>(f), std::forward<G>(g));
+    } else {
+        f();
+        g();
+    }
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+typename Tree<T, Compare, Allocator, Augment, Links>::size_type Tree<T, Compare, Allocator, Augment, Links>::blackHeight(Node* node) const {
+    size_type height = 0;
+    for (; node != nil; node = node->left) {
+        if (node->color == Node::BLACK) {
+            height++;
+        }
+    }
+    return height;
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+typename Tree<T, Compare, Allocator, Augment, Links>::Subtree Tree<T, Compare, Allocator, Augment, Links>::measured(Node* node) const {
+    // Высота считается один раз на входе в операцию, дальше передается вниз
+    return Subtree{node, blackHeight(node)};
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+void Tree<T, Compare, Allocator, Augment, Links>::detachChildren(Node* node, Node*& left, Node*& right) {
+    left = node->left;
+    right = node->right;
+    if (left != nil) {
+        left->parent = nil;
+    }
+    if (right != nil) {
+        right->parent = nil;
+    }
+    node->left = nil;
+    node->right = nil;
+    node->parent = nil;
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+typename Tree<T, Compare, Allocator, Augment, Links>::Subtree Tree<T, Compare, Allocator, Augment, Links>::joinTrees(Subtree left, Node* middle, Subtree right) {
+    // Все ключи left < middle < всех ключей right. Красный корень можно перекрасить в черный.
+    for (Subtree* part : {&left, &right}) {
+        if (part->root != nil && part->root->color == Node::RED) {
+            part->root->color = Node::BLACK;
+            part->height++;
+        }
+    }
+    
+    middle->parent = nil;
+    if (left.height == right.height) {
+        middle->left = left.root;
+        middle->right = right.root;
+        middle->color = Node::BLACK;
+        if (left.root != nil) {
+            left.root->parent = middle;
+        }
+        if (right.root != nil) {
+            right.root->parent = middle;
+        }
+        updateAugment(middle);
+        return Subtree{middle, left.height + 1};
+    }
+    
+    // Спуск по краю более высокого дерева до черного узла с черной высотой низкого.
+    // middle вставляется туда красным, нарушения чинит обычный fixInsert.
+    bool leftTaller = left.height > right.height;
+    Node* top = leftTaller ? left.root : right.root;
+    size_type lowHeight = leftTaller ? right.height : left.height;
+    size_type topHeight = leftTaller ? left.height : right.height;
+    size_type height = topHeight;
+    Node* parent = nil;
+    Node* cur = top;
+    while (cur->color != Node::BLACK || height != lowHeight) {
+        if (cur->color == Node::BLACK) {
+            height--;
+        }
+        parent = cur;
+        cur = leftTaller ? cur->right : cur->left;
+    }
+    
+    middle->color = Node::RED;
+    middle->parent = parent;
+    if (leftTaller) {
+        middle->left = cur;
+        middle->right = right.root;
+        parent->right = middle;
+    } else {
+        middle->left = left.root;
+        middle->right = cur;
+        parent->left = middle;
+    }
+    if (middle->left != nil) {
+        middle->left->parent = middle;
+    }
+    if (middle->right != nil) {
+        middle->right->parent = middle;
+    }
+    
+    updatePath(middle);
+    // Высота меняется, только если перекрашивание дошло до корня
+    bool grown = fixInsert(middle, top);
+    return Subtree{top, topHeight + (grown ? 1 : 0)};
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+typename Tree<T, Compare, Allocator, Augment, Links>::Subtree Tree<T, Compare, Allocator, Augment, Links>::joinTrees(Subtree left, Subtree right) {
+    if (left.root == nil) {
+        return right;
+    }
+    if (right.root == nil) {
+        return left;
+    }
+    Subtree rest;
+    Node* last;
+    splitLast(left, rest, last);
+    return joinTrees(rest, last, right);
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+void Tree<T, Compare, Allocator, Augment, Links>::splitTree(Subtree tree, const T& key, Subtree& left, Node*& found, Subtree& right) {
+    if (tree.root == nil) {
+        left = Subtree{nil, 0};
+        found = nil;
+        right = Subtree{nil, 0};
+        return;
+    }
+    
+    Node* node = tree.root;
+    size_type childHeight = tree.childHeight();
+    Node* nodeLeft;
+    Node* nodeRight;
+    detachChildren(node, nodeLeft, nodeRight);
+    
+    if (comp(key, node->val)) {
+        Subtree middle;
+        splitTree(Subtree{nodeLeft, childHeight}, key, left, found, middle);
+        right = joinTrees(middle, node, Subtree{nodeRight, childHeight});
+    } else if (comp(node->val, key)) {
+        Subtree middle;
+        splitTree(Subtree{nodeRight, childHeight}, key, middle, found, right);
+        left = joinTrees(Subtree{nodeLeft, childHeight}, node, middle);
+    } else {
+        left = Subtree{nodeLeft, childHeight};
+        found = node;
+        right = Subtree{nodeRight, childHeight};
+    }
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+void Tree<T, Compare, Allocator, Augment, Links>::splitLast(Subtree tree, Subtree& rest, Node*& last) {
+    Node* node = tree.root;
+    size_type childHeight = tree.childHeight();
+    Node* nodeLeft;
+    Node* nodeRight;
+    detachChildren(node, nodeLeft, nodeRight);
+    
+    if (nodeRight == nil) {
+        rest = Subtree{nodeLeft, childHeight};
+        last = node;
+        return;
+    }
+    Subtree middle;
+    splitLast(Subtree{nodeRight, childHeight}, middle, last);
+    rest = joinTrees(Subtree{nodeLeft, childHeight}, node, middle);
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+typename Tree<T, Compare, Allocator, Augment, Links>::Subtree Tree<T, Compare, Allocator, Augment, Links>::unionTrees(Subtree a, Subtree b, size_type depth, Discarded& discarded) {
+    // a и b - узлы этого дерева (b скопировано из другого дерева заранее)
+    if (a.root == nil) {
+        return b;
+    }
+    if (b.root == nil) {
+        return a;
+    }
+    
+    Node* middle = b.root;
+    size_type childHeight = b.childHeight();
+    Node* bLeft;
+    Node* bRight;
+    detachChildren(middle, bLeft, bRight);
+    Subtree aLeft;
+    Node* found;
+    Subtree aRight;
+    splitTree(a, middle->val, aLeft, found, aRight);
+    if (found != nil) {
+        discarded.add(found);
+    }
+    
+    Subtree left;
+    Subtree right;
+    forkJoin(depth,
+        [&] { left = unionTrees(aLeft, Subtree{bLeft, childHeight}, depth + 1, discarded); },
+        [&] { right = unionTrees(aRight, Subtree{bRight, childHeight}, depth + 1, discarded); });
+    return joinTrees(left, middle, right);
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+typename Tree<T, Compare, Allocator, Augment, Links>::Subtree Tree<T, Compare, Allocator, Augment, Links>::intersectTrees(Subtree a, Subtree b, size_type depth, Discarded& discarded) {
+    // b принадлежит другому дереву и только читается
+    if (a.root == nil) {
+        return Subtree{nil, 0};
+    }
+    if (b.root == nil) {
+        std::vector<Node*> stack{a.root};
+        while (!stack.empty()) {
+            Node* node = stack.back();
+            stack.pop_back();
+            if (node->left != nil) {
+                stack.push_back(node->left);
+            }
+            if (node->right != nil) {
+                stack.push_back(node->right);
+            }
+            discarded.add(node);
+        }
+        return Subtree{nil, 0};
+    }
+    
+    size_type childHeight = b.childHeight();
+    Subtree aLeft;
+    Node* found;
+    Subtree aRight;
+    splitTree(a, b.root->val, aLeft, found, aRight);
+    
+    Subtree left;
+    Subtree right;
+    forkJoin(depth,
+        [&] { left = intersectTrees(aLeft, Subtree{b.root->left, childHeight}, depth + 1, discarded); },
+        [&] { right = intersectTrees(aRight, Subtree{b.root->right, childHeight}, depth + 1, discarded); });
+    return found != nil ? joinTrees(left, found, right) : joinTrees(left, right);
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+typename Tree<T, Compare, Allocator, Augment, Links>::Subtree Tree<T, Compare, Allocator, Augment, Links>::differenceTrees(Subtree a, Subtree b, size_type depth, Discarded& discarded) {
+    // b принадлежит другому дереву и только читается
+    if (a.root == nil || b.root == nil) {
+        return a;
+    }
+    
+    size_type childHeight = b.childHeight();
+    Subtree aLeft;
+    Node* found;
+    Subtree aRight;
+    splitTree(a, b.root->val, aLeft, found, aRight);
+    if (found != nil) {
+        discarded.add(found);
+    }
+    
+    Subtree left;
+    Subtree right;
+    forkJoin(depth,
+        [&] { left = differenceTrees(aLeft, Subtree{b.root->left, childHeight}, depth + 1, discarded); },
+        [&] { right = differenceTrees(aRight, Subtree{b.root->right, childHeight}, depth + 1, discarded); });
+    return joinTrees(left, right);
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+Tree<T, Compare, Allocator, Augment, Links> Tree<T, Compare, Allocator, Augment, Links>::split(const T& key) {
+    Tree result(comp, get_allocator());
+    if (root == nil) {
+        return result;
+    }
+    
+    // Список соседей рвется только на границе частей
+    if constexpr (Links::threaded) {
+        Node* boundary = lowerBound(key);
+        if (boundary != nil && boundary->prev != nil) {
+            boundary->prev->next = nil;
+            boundary->prev = nil;
+        }
+    }
+    
+    Subtree left;
+    Node* found;
+    Subtree right;
+    splitTree(measured(root), key, left, found, right);
+    if (found != nil) {
+        right = joinTrees(Subtree{nil, 0}, found, right);
+    }
+    
+    root = left.root;
+    result.root = right.root;
+    for (Tree* part : {this, &result}) {
+        if (part->root != nil) {
+            part->root->color = Node::BLACK;
+        }
+        part->refreshExtremes();
+    }
+    
+    // Узлы обеих частей остаются в одном пуле
+    result.pool = pool;
+    pool->markShared();
+    
+    size_type total = treeSize;
+    if constexpr (Augment::hasSubtreeSize) {
+        treeSize = root->subtreeSize;
+        result.treeSize = result.root->subtreeSize;
+    } else {
+        // Обе части проходятся одновременно до конца меньшей
+        size_type steps = 0;
+        Node* lower = leftmost;
+        Node* upper = result.leftmost;
+        while (lower != nil && upper != nil) {
+            lower = nextNode(lower);
+            upper = nextNode(upper);
+            steps++;
+        }
+        treeSize = lower == nil ? steps : total - steps;
+        result.treeSize = total - treeSize;
+    }
+    return result;
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+void Tree<T, Compare, Allocator, Augment, Links>::join(Tree& other) {
+    if (this == &other || other.root == nil) {
+        return;
+    }
+    if (root == nil) {
+        std::swap(root, other.root);
+        std::swap(leftmost, other.leftmost);
+        std::swap(rightmost, other.rightmost);
+        std::swap(treeSize, other.treeSize);
+        std::swap(pool, other.pool);
+        return;
+    }
+    if (!comp(rightmost->val, other.leftmost->val)) {
+        throw std::invalid_argument("Tree::join: keys of the joined tree must be greater than all keys of this tree");
+    }
+    
+    size_type otherSize = other.treeSize;
+    Node* otherRoot;
+    bool copied = false;
+    if (sharePoolWith(other)) {
+        otherRoot = other.root;
+        if constexpr (Links::threaded) {
+            rightmost->next = other.leftmost;
+            other.leftmost->prev = rightmost;
+        }
+        rightmost = other.rightmost;
+        other.root = nil;
+        other.leftmost = nil;
+        other.rightmost = nil;
+        other.treeSize = 0;
+    } else {
+        // Несовместимые пулы: узлы копируются
+        otherSize = other.size();
+        otherRoot = copyTree(other.root, other.nil, otherSize);
+        other.clear();
+        copied = true;
+    }
+    
+    root = joinTrees(measured(root), measured(otherRoot)).root;
+    root->color = Node::BLACK;
+    treeSize += otherSize;
+    if (copied) {
+        restoreLinks();
+    }
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+void Tree<T, Compare, Allocator, Augment, Links>::union_with(const Tree& other) {
+    if (this == &other || other.root == nil) {
+        return;
+    }
+    
+    size_type otherSize = other.size();
+    Node* copy = copyTree(other.root, other.nil, otherSize);
+    std::vector<Node*> added;
+    if constexpr (Links::threaded) {
+        added.reserve(otherSize);
+        for (Node* node = minimum(copy); node != nil; node = successor(node)) {
+            added.push_back(node);
+        }
+    }
+    
+    // Копия стоит первым аргументом: при совпадении ключей остается существующий узел
+    Discarded discarded;
+    root = unionTrees(measured(copy), measured(root), 0, discarded).root;
+    root->color = Node::BLACK;
+    threadNodes(added, discarded.nodes);
+    refreshExtremes();
+    for (Node* node : discarded.nodes) {
+        destroyNode(node);
+    }
+    adjustSize(otherSize, discarded.nodes.size());
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+void Tree<T, Compare, Allocator, Augment, Links>::intersect_with(const Tree& other) {
+    if (this == &other) {
+        return;
+    }
+    
+    Discarded discarded;
+    root = intersectTrees(measured(root), other.measured(other.root), 0, discarded).root;
+    if (root != nil) {
+        root->color = Node::BLACK;
+    }
+    for (Node* node : discarded.nodes) {
+        unthread(node);
+        destroyNode(node);
+    }
+    refreshExtremes();
+    adjustSize(0, discarded.nodes.size());
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+void Tree<T, Compare, Allocator, Augment, Links>::difference_with(const Tree& other) {
+    if (this == &other) {
+        clear();
+        return;
+    }
+    
+    Discarded discarded;
+    root = differenceTrees(measured(root), other.measured(other.root), 0, discarded).root;
+    if (root != nil) {
+        root->color = Node::BLACK;
+    }
+    for (Node* node : discarded.nodes) {
+        unthread(node);
+        destroyNode(node);
+    }
+    refreshExtremes();
+    adjustSize(0, discarded.nodes.size());
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+typename Tree<T, Compare, Allocator, Augment, Links>::iterator Tree<T, Compare, Allocator, Augment, Links>::nth(size_type k) const {
+    static_assert(Augment::hasSubtreeSize, "nth() requires an augmentation with subtree sizes");
+    if (k >= size()) {
+        return end();
+    }
+    
+    Node* node = root;
+    while (true) {
+        size_type leftSize = node->left->subtreeSize;
+        if (k < leftSize) {
+            node = node->left;
+        } else if (k == leftSize) {
+            return iterator(node, nil, this);
+        } else {
+            k -= leftSize + 1;
+            node = node->right;
+        }
+    }
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+typename Tree<T, Compare, Allocator, Augment, Links>::size_type Tree<T, Compare, Allocator, Augment, Links>::rank(const T& value) const {
+    static_assert(Augment::hasSubtreeSize, "rank() requires an augmentation with subtree sizes");
+    // Количество элементов, строго меньших value
+    size_type result = 0;
+    Node* node = root;
+    while (node != nil) {
+        if (comp(node->val, value)) {
+            result += node->left->subtreeSize + 1;
+            node = node->right;
+        } else {
+            node = node->left;
+        }
+    }
+    return result;
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+typename Tree<T, Compare, Allocator, Augment, Links>::size_type Tree<T, Compare, Allocator, Augment, Links>::count_range(const T& lo, const T& hi) const {
+    // Количество элементов в отрезке [lo, hi]
+    if (comp(hi, lo)) {
+        return 0;
+    }
+    return rank(hi) - rank(lo) + count(hi);
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+template <typename A>
+typename A::aggregate_type Tree<T, Compare, Allocator, Augment, Links>::aggregate(const T& lo, const T& hi) const {
+    using Monoid = typename A::monoid_type;
+    
+    // Узел, в котором пути к lo и hi расходятся
+    Node* split = root;
+    while (split != nil) {
+        if (comp(split->val, lo)) {
+            split = split->right;
+        } else if (comp(hi, split->val)) {
+            split = split->left;
+        } else {
+            break;
+        }
+    }
+    if (split == nil) {
+        return Monoid::identity();
+    }
+    
+    // Левая ветка: элементы >= lo, собираются справа налево
+    typename A::aggregate_type leftPart = Monoid::identity();
+    for (Node* x = split->left; x != nil;) {
+        if (!comp(x->val, lo)) {
+            leftPart = Monoid::combine(Monoid::combine(Monoid::lift(x->val), x->right->subtreeAggregate), leftPart);
+            x = x->left;
+        } else {
+            x = x->right;
+        }
+    }
+    
+    // Правая ветка: элементы <= hi, собираются слева направо
+    typename A::aggregate_type rightPart = Monoid::identity();
+    for (Node* x = split->right; x != nil;) {
+        if (!comp(hi, x->val)) {
+            rightPart = Monoid::combine(rightPart, Monoid::combine(x->left->subtreeAggregate, Monoid::lift(x->val)));
+            x = x->right;
+        } else {
+            x = x->left;
+        }
+    }
+    
+    return Monoid::combine(Monoid::combine(leftPart, Monoid::lift(split->val)), rightPart);
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+typename Tree<T, Compare, Allocator, Augment, Links>::size_type Tree<T, Compare, Allocator, Augment, Links>::nodeRank(Node* node) const {
+    static_assert(Augment::hasSubtreeSize, "distance() requires an augmentation with subtree sizes");
+    if (node == nil || node == nullptr) {
+        return size();
+    }
+    
+    size_type result = node->left->subtreeSize;
+    while (node->parent != nil) {
+        if (node == node->parent->right) {
+            result += node->parent->left->subtreeSize + 1;
+        }
+        node = node->parent;
+    }
+    return result;
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+typename Tree<T, Compare, Allocator, Augment, Links>::difference_type
+Tree<T, Compare, Allocator, Augment, Links>::distance(iterator first, iterator last) const {
+    return static_cast<difference_type>(nodeRank(last.getNode())) - static_cast<difference_type>(nodeRank(first.getNode()));
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+typename Tree<T, Compare, Allocator, Augment, Links>::size_type Tree<T, Compare, Allocator, Augment, Links>::size() const {
     return treeSize;
 }
 
-template <typename T>
-bool Tree<T>::empty() const {
-    return treeSize == 0;
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+bool Tree<T, Compare, Allocator, Augment, Links>::empty() const {
+    return root == nil;
 }
 
-template <typename T>
-void Tree<T>::clearRecursive(Node* node) {
-    if (node != nil && node != nullptr) {
-        clearRecursive(node->left);
-        clearRecursive(node->right);
-        delete node;
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+typename Tree<T, Compare, Allocator, Augment, Links>::allocator_type Tree<T, Compare, Allocator, Augment, Links>::get_allocator() const {
+    return alloc;
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+typename Tree<T, Compare, Allocator, Augment, Links>::key_compare Tree<T, Compare, Allocator, Augment, Links>::key_comp() const {
+    return comp;
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+FrozenTree<T, Compare, Allocator> Tree<T, Compare, Allocator, Augment, Links>::freeze() const {
+    return FrozenTree<T, Compare, Allocator>(begin(), size(), comp, get_allocator());
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+template <typename Dispose>
+void Tree<T, Compare, Allocator, Augment, Links>::consumeSubtree(Node* node, Dispose&& dispose) {
+    // Левый ребенок поворотом поднимается наверх, пока его нет; тогда узел
+    // уничтожается и обход продолжается с правого. Ни стека, ни рекурсии
+    while (node != nil && node != nullptr) {
+        Node* left = node->left;
+        if (left != nil) {
+            node->left = left->right;
+            left->right = node;
+            node = left;
+        } else {
+            Node* right = node->right;
+            dispose(node);
+            node = right;
+        }
     }
 }
 
-template <typename T>
-void Tree<T>::clear() {
-    clearRecursive(root);
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+void Tree<T, Compare, Allocator, Augment, Links>::destroyValues(Node* node, size_type depth) {
+    // Только деструкторы: память пула потом освобождается целиком, поэтому
+    // поддеревья верхних уровней обрабатываются параллельно
+    if (depth < ThreadPool::instance().parallelDepth() && node->left != nil && node->right != nil) {
+        forkJoin(depth,
+            [&] { destroyValues(node->left, depth + 1); },
+            [&] { destroyValues(node->right, depth + 1); });
+        node->val.~T();
+        pool->destroyInPlace(node);
+        return;
+    }
+    consumeSubtree(node, [this](Node* victim) {
+        victim->val.~T();
+        pool->destroyInPlace(victim);
+    });
+}
+
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+void Tree<T, Compare, Allocator, Augment, Links>::clear() {
+    // Память возвращается слэбами целиком, обход нужен только ради деструкторов.
+    // Общий пул освобождать нельзя: узлы возвращаются в него по одному.
+    bool exclusivePool = pool.use_count() == 1;
+    if (!exclusivePool) {
+        consumeSubtree(root, [this](Node* victim) { destroyNode(victim); });
+    } else if (root != nil && (!std::is_trivially_destructible<T>::value ||
+               !std::is_trivially_destructible<typename Augment::NodeData>::value)) {
+        destroyValues(root, treeSize < parallelMinNodes ? ThreadPool::instance().parallelDepth() : 0);
+    }
+    if (exclusivePool) {
+        pool->release();
+    }
     root = nil;
+    leftmost = nil;
+    rightmost = nil;
     treeSize = 0;
 }
 
+template <typename T, typename Compare, typename Allocator, typename Augment, typename Links>
+void Tree<T, Compare, Allocator, Augment, Links>::clear_async() {
+    if (root == nil) {
+        clear();
+        return;
+    }
+    // Содержимое переезжает в отдельное дерево, которое уничтожит пул потоков
+    auto detached = std::make_shared<Tree>(std::move(*this));
+    ThreadPool::instance().post([detached] { detached->clear(); });
+}
+
+// Дерево с порядковыми статистиками
+template <typename T, typename Compare = std::less<T>, typename Allocator = std::allocator<T>>
+using OrderStatisticTree = Tree<T, Compare, Allocator, OrderStatistics>;
+
+// Прошитое дерево: итерация по prev/next за O(1) на шаг
+template <typename T, typename Compare = std::less<T>, typename Allocator = std::allocator<T>>
+using ThreadedTree = Tree<T, Compare, Allocator, NoAugment, ThreadedLinks>;
+
 #endif // TREE_HPP